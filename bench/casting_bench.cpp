@@ -0,0 +1,90 @@
+/*!
+ *@file casting_bench.cpp
+ *@brief 类型判定基准
+ *@version 1.0.0
+ *@date 2022-10-04
+ *@note
+ *---------
+ *构建50个函数、每个4000条add/mul指令的模块，测量：
+ *&emsp; 常量折叠与操作数打印：20遍isStaticCalculable/calculate，
+ *&emsp; 并对两个操作数调用print_as_op
+ *&emsp; Module::print：打印整个模块
+ *两者都以isa/dyn_cast判定操作数是否为常量、全局量等
+ */
+
+#include "BasicBlock.h"
+#include "Constant.h"
+#include "Function.h"
+#include "IRbuilder.h"
+#include "IRprinter.h"
+#include "Module.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+/*!
+ *@brief 构建基准模块
+ *@param m 所从属模块
+ *@param num_funcs 函数个数
+ *@param num_instrs 每个函数的运算指令条数
+ *@return 所有运算指令
+ *@note 每三条中一条为两个常量相加，可折叠；其余为链式乘法
+ */
+std::vector<Instruction *> build(Module *m, unsigned num_funcs,
+                                 unsigned num_instrs) {
+  auto i32 = m->get_int32_type();
+  std::vector<Instruction *> instrs;
+  instrs.reserve(static_cast<std::size_t>(num_funcs) * num_instrs);
+  for (unsigned fi = 0; fi < num_funcs; fi++) {
+    auto f = Function::create(FunctionType::get(i32, {i32}),
+                              "f" + std::to_string(fi), m);
+    auto bb = BasicBlock::create(m, "entry", f);
+    IRBuilder builder(bb, m);
+    Value *acc = *f->arg_begin();
+    for (unsigned i = 0; i < num_instrs; i++) {
+      Value *c = ConstantInt::get(static_cast<int>(i), m);
+      Value *x = i % 3 == 0 ? builder.create_iadd(c, ConstantInt::get(1, m))
+                            : builder.create_imul(acc, c);
+      instrs.push_back(static_cast<Instruction *>(x));
+      acc = x;
+    }
+    builder.create_ret(acc);
+  }
+  return instrs;
+}
+} // namespace
+
+int main() {
+  using clock = std::chrono::steady_clock;
+  Module m("bench");
+  auto instrs = build(&m, 50, 4000);
+  m.set_print_name();
+
+  auto start = clock::now();
+  long folded = 0;
+  std::size_t chars = 0;
+  for (int pass = 0; pass < 20; pass++) {
+    for (auto instr : instrs) {
+      if (instr->isStaticCalculable()) {
+        folded += instr->calculate();
+      }
+      chars += print_as_op(instr->get_operand(0), false).size();
+      chars += print_as_op(instr->get_operand(1), false).size();
+    }
+  }
+  auto mid = clock::now();
+  std::string text = m.print();
+  auto end = clock::now();
+
+  auto ms = [](clock::time_point a, clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+  };
+  std::printf("fold + print_as_op %9.1f ms  (%ld folded, %zu chars)\n",
+              ms(start, mid), folded, chars);
+  std::printf("Module::print      %9.1f ms  (%zu chars)\n", ms(mid, end),
+              text.size());
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*!
+ *@file init_builder_bench.cpp
+ *@brief 嵌套初值构建基准
+ *@version 1.0.0
+ *@date 2022-10-04
+ *@note
+ *---------
+ *对百万级元素的三维表比较两种构建方式：
+ *&emsp; 逐元素：每个标量一个整数常量，每行一个常量数组
+ *&emsp; ConstantArray::build：一次遍历，行为紧凑常量数组，重复行共用
+ */
+
+#include "Constant.h"
+#include "GlobalVariable.h"
+#include "Module.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+/*!
+ *@brief 逐元素构建嵌套常量
+ *@param ty 数组类型
+ *@param data 展平的初值
+ *@param begin 子数组起点
+ *@return 常量数组
+ */
+Constant *build_elementwise(ArrayType *ty, const std::vector<int> &data,
+                            std::size_t begin) {
+  Module *m = ty->get_module();
+  Type *elem = ty->get_element_type();
+  std::vector<Constant *> elems;
+  elems.reserve(ty->get_num_of_elements());
+  for (unsigned i = 0; i < ty->get_num_of_elements(); i++) {
+    if (elem->is_array_type()) {
+      auto sub_ty = static_cast<ArrayType *>(elem);
+      elems.push_back(build_elementwise(
+          sub_ty, data, begin + i * sub_ty->get_num_of_flat_elements()));
+    } else {
+      elems.push_back(ConstantInt::get(data[begin + i], m));
+    }
+  }
+  return ConstantArray::get(ty, elems);
+}
+
+/*!
+ *@brief 运行一组三维表
+ *@param d0 第一维
+ *@param d1 第二维
+ *@param d2 第三维
+ *@param period 行内容重复的周期，0表示各行互不相同
+ */
+void run(unsigned d0, unsigned d1, unsigned d2, unsigned period) {
+  std::vector<int> init(static_cast<std::size_t>(d0) * d1 * d2);
+  for (std::size_t i = 0; i < init.size(); i++) {
+    std::size_t row = i / d2;
+    init[i] = static_cast<int>((period ? row % period : row) * 31 + i % d2);
+  }
+  using clock = std::chrono::steady_clock;
+  for (int pass = 0; pass < 2; pass++) {
+    Module m("bench");
+    auto ty = ArrayType::get(
+        ArrayType::get(ArrayType::get(m.get_int32_type(), d2), d1), d0);
+    auto start = clock::now();
+    Constant *c = pass == 0 ? build_elementwise(ty, init, 0)
+                            : ConstantArray::build(ty, init);
+    auto ms = std::chrono::duration<double, std::milli>(clock::now() - start)
+                  .count();
+    std::printf("[%u][%u][%u] period %-5u %-12s %9.1f ms %10.1f MB  "
+                "%zu arrays\n",
+                d0, d1, d2, period, pass == 0 ? "elementwise" : "build", ms,
+                m.get_arena().get_bytes_used() / 1048576.0,
+                m.get_constant_context().get_num_arrays());
+    (void)c;
+  }
+}
+} // namespace
+
+int main() {
+  run(100, 100, 100, 0);
+  run(100, 100, 100, 16);
+  run(200, 100, 250, 0);
+  run(200, 100, 250, 64);
+  return 0;
+}
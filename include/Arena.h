@@ -0,0 +1,119 @@
+/*!
+ *@file Arena.h
+ *@brief 模块内存池接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_ARENA_H
+#define SYSYC_ARENA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+ *@brief 顺序分配的内存池
+ *@note
+ *---------
+ *从大块内存(slab)中顺序切分，不支持单独释放，
+ *所有内存在内存池析构时一次性归还，并按对象种类统计占用字节
+ */
+class Arena {
+public:
+  /*! 分配对象的种类，用于统计*/
+  enum Kind {
+    TypeKind,
+    ConstantKind,
+    GlobalVariableKind,
+    FunctionKind,
+    ArgumentKind,
+    BasicBlockKind,
+    InstructionKind,
+    OperandKind, // 独立分配的operand槽
+    StringKind,  // 字符串池中的字符
+    NumKinds
+  };
+
+private:
+  static constexpr std::size_t InitialSlabSize = 4096;    // 首个slab大小
+  static constexpr std::size_t MaxSlabSize = 1024 * 1024; // slab大小上限
+
+  std::vector<char *> slabs_;        // 已申请的slab
+  char *cur_ = nullptr;              // 当前slab中的空闲起点
+  char *end_ = nullptr;              // 当前slab的结束位置
+  std::size_t next_slab_size_;       // 下一个slab的大小
+  std::size_t bytes_reserved_ = 0;   // 向系统申请的总字节
+  std::size_t bytes_used_[NumKinds]; // 各种类已分配的字节
+
+  /*!
+   *@brief 申请一个新的slab
+   *@param size slab字节数
+   *@return slab起始地址
+   */
+  char *new_slab(std::size_t size);
+
+public:
+  /*!
+   *@brief 内存池构造函数
+   */
+  Arena();
+
+  /*!
+   *@brief 内存池析构函数，归还所有slab
+   */
+  ~Arena();
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  /*!
+   *@brief 分配一块内存
+   *@param size 字节数
+   *@param align 对齐要求，需为2的幂
+   *@param kind 对象种类
+   *@return 内存起始地址
+   */
+  void *allocate(std::size_t size, std::size_t align, Kind kind);
+
+  /*!
+   *@brief 获取某种对象已分配的字节数
+   *@param kind 对象种类
+   *@return 字节数
+   */
+  std::size_t get_bytes_used(Kind kind) const { return bytes_used_[kind]; }
+
+  /*!
+   *@brief 获取所有对象已分配的字节数
+   *@return 字节数
+   */
+  std::size_t get_bytes_used() const;
+
+  /*!
+   *@brief 获取向系统申请的总字节数
+   *@return 字节数
+   */
+  std::size_t get_bytes_reserved() const { return bytes_reserved_; }
+
+  /*!
+   *@brief 获取对象种类的名称
+   *@param kind 对象种类
+   *@return 名称字符串
+   */
+  static const char *get_kind_name(Kind kind);
+
+  /*!
+   *@brief 打印各种类的内存占用
+   *@return 字符串，每个种类一行
+   */
+  std::string print_usage() const { return print_usage({this}); }
+
+  /*!
+   *@brief 打印多个内存池合计的各种类内存占用
+   *@param arenas 内存池
+   *@return 字符串，每个种类一行
+   */
+  static std::string print_usage(const std::vector<const Arena *> &arenas);
+};
+
+#endif // SYSYC_ARENA_H
@@ -9,12 +9,13 @@
 #define SYSYC_BASICBLOCK_H
 
 #include "Function.h"
+#include "IList.h"
 #include "Instruction.h"
 #include "Module.h"
+#include "SmallVector.h"
 #include "Value.h"
 
 #include <list>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -26,12 +27,23 @@ class Module;
   @brief 基本块节点
 */
 class BasicBlock : public Value {
+public:
+  using InstList = IList<Instruction>;           //!<  侵入式指令链表
+  using BBVector = SmallVector<BasicBlock *, 4>; //!<  基本块小向量
+
 private:
-  std::list<BasicBlock *> pre_bbs_;     //!<  pre basic blocks
-  std::list<BasicBlock *> succ_bbs_;    //!<  subsequence basic blocks
-  std::list<Instruction *> instr_list_; //!<  instruction in basic block
+  BBVector pre_bbs_;                    //!<  pre basic blocks
+  InstList instr_list_;                 //!<  instruction in basic block
   Function *parent_;                    //!<  belong to which function
   bool _fake;                           //!<  is fake basicblock
+  unsigned number_ = 0;                 //!<  dense number in function
+
+  friend class Function;
+
+  /*!
+   *@brief 指令链表修改后使所属函数的编号失效
+   */
+  void invalidate_numbering();
 
 public:
   /*!
@@ -59,131 +71,81 @@ public:
   static BasicBlock *create(Module *m, const std::string &name,
                             Function *parent, bool fake = false) {
     auto prefix = name.empty() ? "" : "label_";
-    return new BasicBlock(m, prefix + name, parent, fake);
+    return new (m) BasicBlock(m, prefix + name, parent, fake);
   }
 
   /*!
-   *@brief 返回基本块的所属函数
-   *@return 所从属的函数对象指针
-   *@note
-   *----------
-   *return parent, or null if none.
-   */
-  Function *get_parent() { return parent_; }
-
-  /*!
-   *@brief 返回基本块的所属模块
-   *@return 从属的模块对象指针
-   *@note
-   *----------
-   *return parent, or null if none.
+   *@brief 从模块内存池分配基本块
+   *@param size 对象大小
+   *@param m 所从属模块
+   *@return 对象起始地址
    */
-  Module *get_module();
+  void *operator new(std::size_t size, Module *m) {
+    return Value::allocate(size, m, Arena::BasicBlockKind);
+  }
 
   /*!
-   *@brief 返回基本块的前置基本块链
-   *@return 前置基本块链
-   *@note
-   *----------
-   *return pre_bbs_, or null if none.
+   *@brief 内存归模块内存池所有，不单独释放
    */
-  std::list<BasicBlock *> &get_pre_basic_blocks() { return pre_bbs_; }
+  void operator delete(void *) {}
 
   /*!
-   *@brief 返回基本块的前置基本块链
-   *@return 后置基本块链
+   *@brief 返回基本块的所属函数
+   *@return 所从属的函数对象指针
    *@note
    *----------
-   *return succ_bbs_, or null if none.
+   *return parent, or null if none.
    */
-  std::list<BasicBlock *> &get_succ_basic_blocks() { return succ_bbs_; }
+  Function *get_parent() { return parent_; }
 
   /*!
-   *@brief 向前置基本块链中插入新的基本块
-   *@param bb 待插入的基本块指针
-   *@note
-   *----------
+   *@brief 返回基本块在所属函数内的稠密编号
+   *@return 编号，位于[0, 基本块数)
+   *@note 需所属函数先调用compute_numbering，编号失效时断言
    */
-  void add_pre_basic_block(BasicBlock *bb) { pre_bbs_.push_back(bb); }
+  unsigned get_number() const;
 
   /*!
-   *@brief 向后置基本块链中插入新的基本块
-   *@param bb 待插入的基本块指针
+   *@brief 返回基本块的所属模块
+   *@return 从属的模块对象指针
    *@note
    *----------
    *return parent, or null if none.
    */
-  void add_succ_basic_block(BasicBlock *bb) { succ_bbs_.push_back(bb); }
+  Module *get_module();
 
   /*!
-   *@brief 更新基本块的前置基本块链
-   *@param bb_list 基本块链的集合
+   *@brief 返回基本块的前置基本块
+   *@return 前置基本块向量
    *@note
    *----------
-   *&emsp; 清空原先的前置基本块链
-   *&emsp; 用新的基本块链进行填充
+   *由各前置基本块终结指令的operand维护，跳转目标修改时随之更新；
+   *条件跳转的两个目标相同时，前置基本块出现两次
    */
-  void set_pre_bb(const std::set<BasicBlock *> &bb_list) {
-    pre_bbs_.clear();
-    pre_bbs_.insert(pre_bbs_.begin(), bb_list.begin(), bb_list.end());
-  }
+  const BBVector &get_pre_basic_blocks() const { return pre_bbs_; }
 
   /*!
-   *@brief 更新基本块的后置基本块链
-   *@param bb_list 基本块链的集合
+   *@brief 返回基本块的后置基本块
+   *@return 后置基本块向量
    *@note
    *----------
-   *&emsp; 清空原先的后置基本块链
-   *&emsp; 用新的基本块链进行填充
+   *由终结指令的operand推导，不单独存储，无终结指令时为空
    */
-  void set_succ_bb(const std::set<BasicBlock *> &bb_list) {
-    succ_bbs_.clear();
-    succ_bbs_.insert(succ_bbs_.begin(), bb_list.begin(), bb_list.end());
-  }
+  BBVector get_succ_basic_blocks() const;
 
   /*!
-   *@brief 替换指定的基本块
-   *@param oldBB 被替换的旧基本块指针
-   *@param newBB 用于替换的新基本块指针
-   *@note
-   *----------
-   *####1 替换前置基本块链中的旧基本块
-   *&emsp; **for** 遍历前置链表
-   *&emsp;&emsp; 如果匹配到指定的基本块指针，进行替换
-   *####2 替换后置基本块链中的就基本块
-   *&emsp; **for** 遍历后置链表
-   *&emsp;&emsp; 如果匹配到指定的基本块指针，进行替换
+   *@brief 跳转指令的目标operand挂链时记录前置基本块
+   *@param bb 跳转指令所在的基本块
+   *@note 由use节点的挂链操作调用，不应直接调用
    */
-  void replace_basic_block(BasicBlock *oldBB, BasicBlock *newBB) {
-    for (auto it = pre_bbs_.begin(); it != pre_bbs_.end(); ++it) {
-      if (*it == oldBB) {
-        *it = newBB;
-      }
-    }
-    for (auto it = succ_bbs_.begin(); it != succ_bbs_.end(); ++it) {
-      if (*it == oldBB) {
-        *it = newBB;
-      }
-    }
-  }
-
-  /*!
-   *@brief 删除前置基本块链的指定基本块
-   *@param 待删除的基本块指针
-   *@note
-   *----------
-   *pre list remove bb
-   */
-  void remove_pre_basic_block(BasicBlock *bb) { pre_bbs_.remove(bb); }
+  void add_pre_basic_block(BasicBlock *bb) { pre_bbs_.push_back(bb); }
 
   /*!
-   *@brief 删除后置基本块链的指定基本块
-   *@param 待删除的基本块指针
-   *@note
-   *----------
-   *succ list remove bb
+   *@brief 跳转指令的目标operand摘链时删除前置基本块
+   *@param bb 跳转指令所在的基本块
+   *@note 由use节点的摘链操作调用，不应直接调用；只删除一次出现
    */
-  void remove_succ_basic_block(BasicBlock *bb) { succ_bbs_.remove(bb); }
+  void remove_pre_basic_block(BasicBlock *bb);
 
   /*!
    *@brief 获取基本块内的终结指令
@@ -215,7 +177,7 @@ public:
    *@param instr 待添加的指令指针
    *@note
    *----------
-   *在基本块的尾部添加指令
+   *在基本块的尾部添加指令，O(1)
    */
   void add_instruction(Instruction *instr);
 
@@ -224,7 +186,7 @@ public:
    *@param instr 待添加的指令指针
    *@note
    *----------
-   *在基本块的头部添加指令
+   *在基本块的头部添加指令，O(1)
    */
   void add_instr_begin(Instruction *instr);
 
@@ -233,23 +195,51 @@ public:
    *@param 待添加的指令指针
    *@note
    *----------
-   *向phi指令后添加指令
+   *向phi指令后添加指令，只扫描块首的phi指令
    */
   void add_instr_after_phi(Instruction *instr);
 
+  /*!
+   *@brief 在指定指令之前插入指令
+   *@param pos 基本块中的指令
+   *@param instr 不在任何基本块中的指令
+   *@note
+   *----------
+   *O(1)，设置指令的从属基本块
+   */
+  void insert_instr_before(Instruction *pos, Instruction *instr);
+
+  /*!
+   *@brief 在指定指令之后插入指令
+   *@param pos 基本块中的指令
+   *@param instr 不在任何基本块中的指令
+   *@note
+   *----------
+   *O(1)，设置指令的从属基本块
+   */
+  void insert_instr_after(Instruction *pos, Instruction *instr);
+
+  /*!
+   *@brief 将from中[first, last)的指令移动到pos之前
+   *@param pos 本基本块中的插入位置
+   *@param from 源基本块，可以是本基本块
+   *@param first 区间起点
+   *@param last 区间终点
+   *@note
+   *----------
+   *链表指针修改为O(1)，跨基本块时逐条修改指令的从属基本块并顺带计数
+   */
+  void splice(InstList::iterator pos, BasicBlock *from,
+              InstList::iterator first, InstList::iterator last);
+
   /*!
    *@brief 删除基本块中的某个指令
    *@param 待删除的指令指针
    *@note
    *----------
-   *&emsp; 删除维护的指令链表中的指令
-   *&emsp; 获取删除的指令的前后指令
-   *&emsp; 修正指令的链接关系：，
-   *&emsp; **if** 如果前置指令不为空
-   *&emsp;&emsp; 为前置指令设置新的后置指令
-   *&emsp; **if** 如果后置指令不为空
-   *&emsp;&emsp; 为后置指令设置新的前置指令
+   *&emsp; 从侵入式指令链表中摘除指令，O(1)
    *&emsp; 被删除的指令进行相关use的删除
+   *&emsp; 指令对象保留，回收内存使用Instruction::erase_from_parent
    */
   void delete_instr(Instruction *instr);
 
@@ -277,7 +267,7 @@ public:
    *@note
    *----------
    */
-  int get_num_of_instr() { return instr_list_.size(); }
+  int get_num_of_instr() { return (int)instr_list_.size(); }
 
   /*!
    *@brief 获取基本块的指针链表
@@ -285,7 +275,7 @@ public:
    *@note
    *----------
    */
-  std::list<Instruction *> &get_instructions() { return instr_list_; }
+  InstList &get_instructions() { return instr_list_; }
 
   /*!
    *@brief 将基本块从从属的函数中删除
@@ -295,13 +285,23 @@ public:
    */
   void erase_from_parent();
 
+  /*!
+   *@brief 判断value是否为基本块
+   *@param v value指针
+   *@return 判定结果
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::BasicBlockVal;
+  }
+
   /*!
    *@brief 打印基本块
+   *@param os 输出流
    *@note
    *----------
    *return parent, or null if none.
    */
-  virtual std::string print() override;
+  virtual void print_ir(OutStream &os) override;
 };
 
 #endif
@@ -0,0 +1,65 @@
+/*!
+ *@file Casting.h
+ *@brief 基于ValueID的类型判定与转换接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_CASTING_H
+#define SYSYC_CASTING_H
+
+#include <cassert>
+
+/*!
+ *@brief 判断v是否属于To类型
+ *@param v 待判定的指针，不能为空
+ *@return 判定结果
+ *@note
+ *---------
+ *To类型需提供static bool classof(const Value *)，
+ *判定只比较子类型ID，不经过RTTI
+ */
+template <typename To, typename From> inline bool isa(const From *v) {
+  assert(v && "isa<> used on a null pointer");
+  return To::classof(v);
+}
+
+/*!
+ *@brief 将v转换为To类型，调用者需保证类型正确
+ *@param v 待转换的指针
+ *@return 转换后的指针
+ */
+template <typename To, typename From> inline To *cast(From *v) {
+  assert(isa<To>(v) && "cast<Ty>() argument of incompatible type!");
+  return static_cast<To *>(v);
+}
+
+template <typename To, typename From> inline const To *cast(const From *v) {
+  assert(isa<To>(v) && "cast<Ty>() argument of incompatible type!");
+  return static_cast<const To *>(v);
+}
+
+/*!
+ *@brief 若v属于To类型则转换，否则返回空
+ *@param v 待转换的指针，不能为空
+ *@return 转换后的指针或nullptr
+ */
+template <typename To, typename From> inline To *dyn_cast(From *v) {
+  return isa<To>(v) ? static_cast<To *>(v) : nullptr;
+}
+
+template <typename To, typename From>
+inline const To *dyn_cast(const From *v) {
+  return isa<To>(v) ? static_cast<const To *>(v) : nullptr;
+}
+
+/*!
+ *@brief 同dyn_cast，但允许v为空
+ *@param v 待转换的指针
+ *@return 转换后的指针或nullptr
+ */
+template <typename To, typename From> inline To *dyn_cast_or_null(From *v) {
+  return (v && isa<To>(v)) ? static_cast<To *>(v) : nullptr;
+}
+
+#endif // SYSYC_CASTING_H
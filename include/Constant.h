@@ -12,6 +12,9 @@
 #include "User.h"
 #include "Value.h"
 
+#include <cassert>
+#include <cstddef>
+
 /*!
  *@brief 常量基类
  *constant variable
@@ -22,18 +25,43 @@ public:
   /*!
    *@brief 常量基类构造函数
    *@param ty 常量类型
+   *@param vid 常量子类型ID
    *@param name 常量名称
    *@param 常量的操作数序号，默认为0
    *@return 自身类对象
    *constant variable
    */
-  Constant(Type *ty, const std::string &name = "", unsigned num_ops = 0)
-      : User(ty, name, num_ops) {}
+  Constant(Type *ty, unsigned vid, std::string_view name = "",
+           unsigned num_ops = 0)
+      : User(ty, vid, name, num_ops) {}
   /*!
    *@brief 常量基类析构函数
    *constant variable
    */
   ~Constant() = default;
+  /*!
+   *@brief 从模块内存池分配常量
+   *@param size 对象大小
+   *@param m 所属模块
+   *@param num_ops operand个数
+   *@return 对象起始地址，operand槽位于其前
+   */
+  void *operator new(std::size_t size, Module *m, unsigned num_ops) {
+    return User::allocate_with_operands(size, m, Arena::ConstantKind, num_ops);
+  }
+  /*!
+   *@brief 内存归模块内存池所有，不单独释放
+   */
+  void operator delete(void *) {}
+  /*!
+   *@brief 判断value是否为常量
+   *@param v value指针
+   *@return 判定结果
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() >= Value::ConstantFirstVal &&
+           v->get_value_id() <= Value::ConstantLastVal;
+  }
 };
 
 /*!
@@ -44,15 +72,20 @@ class ConstantInt : public Constant {
 private:
   int value_; /// 初始值
 
-public:
   /*!
    *@brief 常量整数类构造函数
    *@param ty 常量类型
    *@param val 常量数值
    *@return 自身类对象
+   *@note 仅由常量上下文创建，保证同一模块内唯一
    *constant variable
    */
-  ConstantInt(Type *ty, int val) : Constant(ty, "", 0), value_(val) {}
+  ConstantInt(Type *ty, int val)
+      : Constant(ty, Value::ConstantIntVal, "", 0), value_(val) {}
+
+  friend class ConstantContext;
+
+public:
   /*!
    *@brief 获取常量值
    *@param const_val 常量对象指针
@@ -65,24 +98,79 @@ public:
    */
   int get_value() const { return value_; }
   /*!
-   *@brief 常量整数类32位创建函数
+   *@brief 常量整数类32位获取函数
    *@param val 常量值
    *@param m 所属模块
-   *@return 常量类对象指针
+   *@return 模块内唯一的常量类对象指针，可按指针比较
    */
   static ConstantInt *get(int val, Module *m);
   /*!
-   *@brief 常量整数类1位创建函数
+   *@brief 常量整数类1位获取函数
    *@param val 常量值
    *@param m 所属模块
-   *@return 常量类对象指针
+   *@return true/false单例
    */
   static ConstantInt *get(bool val, Module *m);
+  /*!
+   *@brief 判断value是否为常量整数
+   *@param v value指针
+   *@return 判定结果
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ConstantIntVal;
+  }
   /*!
    *@brief 打印常量类变量
-   *@return 字符串
+   *@param os 输出流
+   */
+  void print_ir(OutStream &os) override;
+};
+
+/*!
+ *@brief 常量浮点数
+ *constant float variable
+ */
+class ConstantFP : public Constant {
+private:
+  float value_; /// 常量值
+
+  /*!
+   *@brief 常量浮点数类构造函数
+   *@param ty 常量类型
+   *@param val 常量数值
+   *@note 仅由常量上下文创建，保证同一模块内唯一
+   */
+  ConstantFP(Type *ty, float val)
+      : Constant(ty, Value::ConstantFPVal, "", 0), value_(val) {}
+
+  friend class ConstantContext;
+
+public:
+  /*!
+   *@brief 获取常量值
+   *@return 常量值
+   */
+  float get_value() const { return value_; }
+  /*!
+   *@brief 常量浮点数类获取函数
+   *@param val 常量值
+   *@param m 所属模块
+   *@return 模块内唯一的常量类对象指针，按位模式区分，0.0与-0.0不同
+   */
+  static ConstantFP *get(float val, Module *m);
+  /*!
+   *@brief 判断value是否为常量浮点数
+   *@param v value指针
+   *@return 判定结果
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ConstantFPVal;
+  }
+  /*!
+   *@brief 打印常量浮点数，格式同LLVM的十六进制双精度
+   *@param os 输出流
    */
-  std::string print() override;
+  void print_ir(OutStream &os) override;
 };
 
 /*!
@@ -101,6 +189,8 @@ private:
    */
   ConstantArray(ArrayType *ty, const std::vector<Constant *> &val);
 
+  friend class ConstantContext;
+
 public:
   /*!
    *@brief 常量整数类析构函数
@@ -124,20 +214,57 @@ public:
   unsigned get_size_of_array() { return const_array.size(); }
 
   /*!
-   *@brief 常量数组类的创建函数
+   *@brief 常量数组类的获取函数
    *@param ty 数组元素的类型
    *@param val 常量类数组
-   *@return 常量数组类指针
+   *@return 常量数组类指针，类型与元素相同时为同一对象
    *constant int array
    */
   static ConstantArray *get(ArrayType *ty, const std::vector<Constant *> &val);
 
+  /*!
+   *@brief 由展平的初值一次构建嵌套常量
+   *@param ty 数组类型，最内层元素须为i32
+   *@param data 按行优先展平的元素
+   *@param n 元素个数，须等于数组展平后的元素个数
+   *@param share 行是否直接引用data而不复制
+   *@return 全零时为ConstantZero，否则为以紧凑常量数组为行的嵌套常量数组
+   *@note
+   *---------
+   *各维共用一个复用的元素缓冲，内容相同的行与子数组只创建一次；
+   *share为真时data须位于模块内存池且不再修改
+   *constant int array
+   */
+  static Constant *build(ArrayType *ty, const int *data, std::size_t n,
+                         bool share = false);
+
+  /*!
+   *@brief 由展平的初值一次构建嵌套常量
+   *@param ty 数组类型，最内层元素须为i32
+   *@param init 按行优先展平的元素
+   *@return 全零时为ConstantZero，否则为嵌套常量数组
+   *constant int array
+   */
+  static Constant *build(ArrayType *ty, const std::vector<int> &init) {
+    return build(ty, init.data(), init.size());
+  }
+
+  /*!
+   *@brief 判断value是否为常量数组
+   *@param v value指针
+   *@return 判定结果
+   *constant int array
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ConstantArrayVal;
+  }
+
   /*!
    *@brief 常量数组类打印函数
-   *@return 字符串
+   *@param os 输出流
    *constant int array
    */
-  std::string print() override;
+  void print_ir(OutStream &os) override;
 
   /*!
    *@brief 常量整数类构造函数
@@ -150,31 +277,337 @@ public:
    */
   static std::vector<Constant *>
   IntegerList2Constant(const std::vector<int> &dim,
-                       const std::vector<int> &init, Module *m) {
-    std::vector<Constant *> st;
-    std::vector<Constant *> ost;
-    Type *ty = Type::get_int32_type(m);
-    for (int i : init) {
-      ost.emplace_back(ConstantInt::get(i, m));
-    }
-    int num_group = init.size();
-    for (int i = (int)dim.size() - 1; i > 0; --i) {
-      num_group /= dim[i];
-      int offset = 0;
-      ty = ArrayType::get(ty, dim[i]);
-      for (int gp = 0; gp < num_group; ++gp) {
-        std::vector<Constant *> arr;
-        for (int j = 0; j < dim[i]; ++j) {
-          arr.push_back(ost[offset + j]);
-        }
-        st.push_back(ConstantArray::get(dynamic_cast<ArrayType *>(ty), arr));
-        offset += dim[i];
-      }
-      ost = st;
-      st.clear();
-    }
-    return ost;
+                       const std::vector<int> &init, Module *m);
+
+};
+
+/*!
+ *@brief 紧凑常量数组
+ *@note
+ *---------
+ *多维数组整体展平，元素以原始int32/float存放在模块内存池中，
+ *不创建元素常量，也不占用operand槽，按展平下标O(1)访问
+ *constant data array
+ */
+class ConstantDataArray : public Constant {
+private:
+  const void *data_;         ///! 元素的原始存储
+  std::size_t num_elements_; ///! 展平后的元素个数
+
+  /*!
+   *@brief 紧凑常量数组构造函数
+   *@param ty 数组类型，可为多维
+   *@param data 已复制到模块内存池的元素存储
+   *@param n 展平后的元素个数
+   *constant data array
+   */
+  ConstantDataArray(ArrayType *ty, const void *data, std::size_t n)
+      : Constant(ty, Value::ConstantDataArrayVal, "", 0), data_(data),
+        num_elements_(n) {}
+
+  friend class ConstantContext;
+
+  /*!
+   *@brief 获取唯一的紧凑常量数组
+   *@param ty 数组类型
+   *@param data 元素存储
+   *@param n 元素个数
+   *@param elem_size 元素大小
+   *@param copy 新建时是否复制元素
+   *@return 紧凑常量数组指针，类型与元素相同时为同一对象
+   *constant data array
+   */
+  static ConstantDataArray *create(ArrayType *ty, const void *data,
+                                   std::size_t n, std::size_t elem_size,
+                                   bool copy = true);
+
+public:
+  /*!
+   *@brief 获取int32紧凑常量数组
+   *@param ty 数组类型，最内层元素须为i32
+   *@param data 按行优先展平的元素
+   *@param n 元素个数，须等于数组展平后的元素个数
+   *@return 紧凑常量数组指针，内容相同时为同一对象
+   *constant data array
+   */
+  static ConstantDataArray *get(ArrayType *ty, const int *data,
+                                std::size_t n);
+  /*!
+   *@brief 获取引用已有存储的int32紧凑常量数组
+   *@param ty 数组类型，最内层元素须为i32
+   *@param data 按行优先展平的元素，须位于模块内存池且不再修改
+   *@param n 元素个数，须等于数组展平后的元素个数
+   *@return 紧凑常量数组指针，新建时不复制元素
+   *constant data array
+   */
+  static ConstantDataArray *get_shared(ArrayType *ty, const int *data,
+                                       std::size_t n);
+  /*!
+   *@brief 获取float紧凑常量数组
+   *@param ty 数组类型，最内层元素须为float
+   *@param data 按行优先展平的元素
+   *@param n 元素个数，须等于数组展平后的元素个数
+   *@return 紧凑常量数组指针，内容相同时为同一对象
+   *constant data array
+   */
+  static ConstantDataArray *get(ArrayType *ty, const float *data,
+                                std::size_t n);
+  /*!
+   *@brief 创建int32紧凑常量数组
+   *@param ty 数组类型，最内层元素须为i32
+   *@param val 按行优先展平的元素
+   *@return 紧凑常量数组指针
+   *constant data array
+   */
+  static ConstantDataArray *get(ArrayType *ty, const std::vector<int> &val) {
+    return get(ty, val.data(), val.size());
+  }
+  /*!
+   *@brief 创建float紧凑常量数组
+   *@param ty 数组类型，最内层元素须为float
+   *@param val 按行优先展平的元素
+   *@return 紧凑常量数组指针
+   *constant data array
+   */
+  static ConstantDataArray *get(ArrayType *ty, const std::vector<float> &val) {
+    return get(ty, val.data(), val.size());
+  }
+
+  /*!
+   *@brief 获取最内层元素类型
+   *@return i32或float类型
+   *constant data array
+   */
+  Type *get_element_type() const {
+    return static_cast<ArrayType *>(get_type())->get_scalar_type();
+  }
+  /*!
+   *@brief 获取展平后的元素个数
+   *@return 元素个数
+   *constant data array
+   */
+  std::size_t get_num_elements() const { return num_elements_; }
+  /*!
+   *@brief 获取int32元素存储
+   *@return 展平的元素数组
+   *constant data array
+   */
+  const int *get_int_data() const {
+    assert(get_element_type()->is_int32_type() && "not an int32 array");
+    return static_cast<const int *>(data_);
+  }
+  /*!
+   *@brief 获取float元素存储
+   *@return 展平的元素数组
+   *constant data array
+   */
+  const float *get_float_data() const {
+    assert(get_element_type()->is_float_type() && "not a float array");
+    return static_cast<const float *>(data_);
+  }
+  /*!
+   *@brief 获取int32元素
+   *@param i 展平下标
+   *@return 元素值
+   *constant data array
+   */
+  int get_int(std::size_t i) const { return get_int_data()[i]; }
+  /*!
+   *@brief 获取float元素
+   *@param i 展平下标
+   *@return 元素值
+   *constant data array
+   */
+  float get_float(std::size_t i) const { return get_float_data()[i]; }
+  /*!
+   *@brief 判断value是否为紧凑常量数组
+   *@param v value指针
+   *@return 判定结果
+   *constant data array
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ConstantDataArrayVal;
+  }
+  /*!
+   *@brief 紧凑常量数组打印函数
+   *@param os 输出流，格式与逐元素的常量数组一致
+   *constant data array
+   */
+  void print_ir(OutStream &os) override;
+};
+
+/*!
+ *@brief 稀疏常量数组
+ *@note
+ *---------
+ *只记录显式初始化的元素区间(run)，区间外的元素均为0；
+ *打印时全零的子数组输出zeroinitializer，末尾全零部分可放入.bss
+ *constant sparse array
+ */
+class ConstantSparseArray : public Constant {
+public:
+  /*! 显式初始化的元素区间，下标为展平下标*/
+  struct Run {
+    std::size_t begin_;  ///! 区间起点
+    std::size_t size_;   ///! 区间长度
+    std::size_t offset_; ///! 区间元素在存储中的起点
+    std::size_t end() const { return begin_ + size_; }
   };
+  /*! 相邻区间之间的零元素少于该值时合并为一个区间*/
+  static constexpr std::size_t MinZeroGap = 8;
+
+private:
+  const Run *runs_;          ///! 按起点递增的区间
+  unsigned num_runs_;        ///! 区间个数
+  const void *data_;         ///! 各区间元素依次存放
+  std::size_t num_elements_; ///! 展平后的元素个数
+
+  /*!
+   *@brief 稀疏常量数组构造函数
+   *@param ty 数组类型，可为多维
+   *@param runs 区间
+   *@param num_runs 区间个数
+   *@param data 区间元素存储
+   *@param n 展平后的元素个数
+   *constant sparse array
+   */
+  ConstantSparseArray(ArrayType *ty, const Run *runs, unsigned num_runs,
+                      const void *data, std::size_t n)
+      : Constant(ty, Value::ConstantSparseArrayVal, "", 0), runs_(runs),
+        num_runs_(num_runs), data_(data), num_elements_(n) {}
+
+  friend class IRReader;
+
+  /*!
+   *@brief 从展平的元素中提取非零区间并创建常量
+   *@param ty 数组类型
+   *@param data 展平的元素，按4字节比较是否为0
+   *@param n 元素个数
+   *@return 全零时为ConstantZero，否则为稀疏常量数组
+   *constant sparse array
+   */
+  static Constant *create(ArrayType *ty, const unsigned *data, std::size_t n);
+
+  /*!
+   *@brief 获取元素的原始4字节
+   *@param i 展平下标
+   *@return 原始值，区间外为0
+   *constant sparse array
+   */
+  unsigned get_bits(std::size_t i) const;
+
+public:
+  /*!
+   *@brief 创建int32稀疏常量数组
+   *@param ty 数组类型，最内层元素须为i32
+   *@param data 按行优先展平的元素
+   *@param n 元素个数，须等于数组展平后的元素个数
+   *@return 全零时为ConstantZero，否则为稀疏常量数组
+   *constant sparse array
+   */
+  static Constant *get(ArrayType *ty, const int *data, std::size_t n);
+  /*!
+   *@brief 创建float稀疏常量数组
+   *@param ty 数组类型，最内层元素须为float
+   *@param data 按行优先展平的元素
+   *@param n 元素个数，须等于数组展平后的元素个数
+   *@return 全零时为ConstantZero，否则为稀疏常量数组
+   *constant sparse array
+   */
+  static Constant *get(ArrayType *ty, const float *data, std::size_t n);
+  /*!
+   *@brief 创建int32稀疏常量数组
+   *@param ty 数组类型，最内层元素须为i32
+   *@param val 按行优先展平的元素
+   *@return 全零时为ConstantZero，否则为稀疏常量数组
+   *constant sparse array
+   */
+  static Constant *get(ArrayType *ty, const std::vector<int> &val) {
+    return get(ty, val.data(), val.size());
+  }
+
+  /*!
+   *@brief 获取最内层元素类型
+   *@return i32或float类型
+   *constant sparse array
+   */
+  Type *get_element_type() const {
+    return static_cast<ArrayType *>(get_type())->get_scalar_type();
+  }
+  /*!
+   *@brief 获取展平后的元素个数
+   *@return 元素个数
+   *constant sparse array
+   */
+  std::size_t get_num_elements() const { return num_elements_; }
+  /*!
+   *@brief 获取区间个数
+   *@return 区间个数
+   *constant sparse array
+   */
+  unsigned get_num_runs() const { return num_runs_; }
+  /*!
+   *@brief 获取第i个区间
+   *@param i 区间序号
+   *@return 区间
+   *constant sparse array
+   */
+  const Run &get_run(unsigned i) const { return runs_[i]; }
+  /*!
+   *@brief 获取int32区间元素存储
+   *@param run 区间
+   *@return 区间的第一个元素
+   *constant sparse array
+   */
+  const int *get_run_ints(const Run &run) const {
+    return static_cast<const int *>(data_) + run.offset_;
+  }
+  /*!
+   *@brief 获取float区间元素存储
+   *@param run 区间
+   *@return 区间的第一个元素
+   *constant sparse array
+   */
+  const float *get_run_floats(const Run &run) const {
+    return static_cast<const float *>(data_) + run.offset_;
+  }
+  /*!
+   *@brief 获取int32元素
+   *@param i 展平下标
+   *@return 元素值，O(log 区间个数)
+   *constant sparse array
+   */
+  int get_int(std::size_t i) const;
+  /*!
+   *@brief 获取float元素
+   *@param i 展平下标
+   *@return 元素值，O(log 区间个数)
+   *constant sparse array
+   */
+  float get_float(std::size_t i) const;
+  /*!
+   *@brief 获取末尾全零部分的起点
+   *@return 展平下标，其后的元素均为0，可放入.bss
+   *constant sparse array
+   */
+  std::size_t get_zero_tail_begin() const {
+    return runs_[num_runs_ - 1].end();
+  }
+  /*!
+   *@brief 判断value是否为稀疏常量数组
+   *@param v value指针
+   *@return 判定结果
+   *constant sparse array
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ConstantSparseArrayVal;
+  }
+  /*!
+   *@brief 稀疏常量数组打印函数
+   *@param os 输出流，全零的子数组打印为zeroinitializer
+   *constant sparse array
+   */
+  void print_ir(OutStream &os) override;
 };
 
 /*! 常量零值
@@ -182,22 +615,34 @@ public:
  */
 class ConstantZero : public Constant {
 private:
-  explicit ConstantZero(Type *ty) : Constant(ty, "", 0) {}
+  explicit ConstantZero(Type *ty)
+      : Constant(ty, Value::ConstantZeroVal, "", 0) {}
+
+  friend class ConstantContext;
 
 public:
   /*!
-   *@brief 常量整数类构造函数
+   *@brief 获取零值常量
    *@param ty 常量类型
-   *@param val 常量数值类型数组
-   *@return 自身类对象
+   *@param m 所属模块
+   *@return 模块内每种类型唯一的零值常量
    *constant int zero
    */
   static ConstantZero *get(Type *ty, Module *m);
+  /*!
+   *@brief 判断value是否为常量零值
+   *@param v value指针
+   *@return 判定结果
+   *constant int zero
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ConstantZeroVal;
+  }
   /*!
    *@brief 打印常量零值
-   *@return 字符串
+   *@param os 输出流
    *constant int zero
    */
-  std::string print() override;
+  void print_ir(OutStream &os) override;
 };
 #endif // SYSYC_CONSTANT_H
@@ -0,0 +1,172 @@
+/*!
+ *@file ConstantContext.h
+ *@brief 常量上下文接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_CONSTANTCONTEXT_H
+#define SYSYC_CONSTANTCONTEXT_H
+
+#include "ShardedMap.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+class Module;
+class Type;
+class ArrayType;
+class Constant;
+class ConstantInt;
+class ConstantFP;
+class ConstantZero;
+class ConstantArray;
+class ConstantDataArray;
+
+/*!
+ *@brief 常量上下文
+ *@note
+ *---------
+ *模块内类型与数值相同的整数常量只创建一次，可直接按指针比较；
+ *布尔常量为两个单例，常用小整数按数值直接索引，其余整数按(类型, 数值)散列；
+ *浮点数按位模式散列，0.0与-0.0、不同的NaN各自唯一；
+ *常量数组按(类型, 元素)散列，紧凑常量数组按(类型, 元素字节)散列，
+ *重复的行只保存一份；
+ *各获取函数可由多个线程并发调用：小整数槽以原子比较交换发布，
+ *其余表分片加锁，不同分片互不阻塞。常量数组创建时会修改各元素的use链，
+ *共用元素的常量数组仍需由调用者串行创建
+ */
+class ConstantContext {
+public:
+  static constexpr int SmallIntMin = -128; // 直接索引的最小整数
+  static constexpr int SmallIntMax = 1023; // 直接索引的最大整数
+
+private:
+  using IntKey = std::pair<Type *, int>; // 整数常量的键：类型与数值
+  /*! 整数常量键的散列*/
+  struct IntKeyHash {
+    std::size_t operator()(const IntKey &key) const;
+  };
+
+  /*! 常量数组的键：类型与元素，登记后指向常量数组自身保存的元素*/
+  struct ArrayKey {
+    ArrayType *ty_;
+    Constant *const *elems_;
+    std::size_t size_;
+    bool operator==(const ArrayKey &rhs) const;
+  };
+  /*! 常量数组键的散列*/
+  struct ArrayKeyHash {
+    std::size_t operator()(const ArrayKey &key) const;
+  };
+
+  /*! 紧凑常量数组的键：类型与元素字节，登记后指向内存池中的元素*/
+  struct DataKey {
+    ArrayType *ty_;
+    const void *data_;
+    std::size_t bytes_;
+    bool operator==(const DataKey &rhs) const;
+  };
+  /*! 紧凑常量数组键的散列*/
+  struct DataKeyHash {
+    std::size_t operator()(const DataKey &key) const;
+  };
+
+  Module *m_;          // 所属模块
+  ConstantInt *true_;  // 布尔真
+  ConstantInt *false_; // 布尔假
+  // 小整数，按数值减SmallIntMin索引
+  std::atomic<ConstantInt *> small_ints_[SmallIntMax - SmallIntMin + 1];
+  // 其余整数
+  ShardedMap<IntKey, ConstantInt *, IntKeyHash> ints_;
+  // 浮点数，按位模式索引
+  ShardedMap<std::uint32_t, ConstantFP *, std::hash<std::uint32_t>> floats_;
+  // 各类型的零值
+  ShardedMap<Type *, ConstantZero *, std::hash<Type *>> zeros_;
+  // 常量数组
+  ShardedMap<ArrayKey, ConstantArray *, ArrayKeyHash> arrays_;
+  // 紧凑常量数组
+  ShardedMap<DataKey, ConstantDataArray *, DataKeyHash> data_arrays_;
+
+public:
+  /*!
+   *@brief 常量上下文构造函数，创建布尔常量
+   *@param m 所属模块，其类型上下文需已构造
+   */
+  explicit ConstantContext(Module *m);
+
+  ConstantContext(const ConstantContext &) = delete;
+  ConstantContext &operator=(const ConstantContext &) = delete;
+
+  /*!
+   *@brief 获取32位整数常量
+   *@param val 常量值
+   *@return 模块内唯一的常量对象指针
+   *@note 小整数按数值直接索引，首次使用时创建，命中时无需加锁
+   */
+  ConstantInt *get_int(int val);
+
+  /*!
+   *@brief 获取浮点数常量
+   *@param val 常量值
+   *@return 位模式相同时返回同一对象
+   */
+  ConstantFP *get_float(float val);
+
+  /*!
+   *@brief 获取布尔常量
+   *@param val 常量值
+   *@return 布尔单例
+   */
+  ConstantInt *get_bool(bool val) const { return val ? true_ : false_; }
+
+  /*!
+   *@brief 获取零值常量
+   *@param ty 常量类型
+   *@return 模块内每种类型唯一的零值常量
+   */
+  ConstantZero *get_zero(Type *ty);
+
+  /*!
+   *@brief 获取常量数组
+   *@param ty 数组类型
+   *@param elems 元素
+   *@return 类型与元素相同时返回同一对象
+   */
+  ConstantArray *get_array(ArrayType *ty, const std::vector<Constant *> &elems);
+
+  /*!
+   *@brief 获取紧凑常量数组
+   *@param ty 数组类型
+   *@param data 展平的元素
+   *@param n 元素个数
+   *@param elem_size 元素大小
+   *@param copy 未命中时是否复制元素
+   *@return 类型与元素字节相同时返回同一对象
+   *@note 默认未命中时元素复制到模块内存池；copy为false时直接引用data，
+   *data须已位于模块内存池或其他归模块所有的存储中，且不再修改
+   */
+  ConstantDataArray *get_data_array(ArrayType *ty, const void *data,
+                                    std::size_t n, std::size_t elem_size,
+                                    bool copy = true);
+
+  /*!
+   *@brief 获取已唯一化的常量数组个数
+   *@return 个数，含紧凑常量数组
+   */
+  std::size_t get_num_arrays() {
+    return arrays_.size() + data_arrays_.size();
+  }
+
+  /*!
+   *@brief 获取已创建的整数常量个数
+   *@return 个数，不含布尔常量
+   */
+  std::size_t get_num_ints();
+};
+
+#endif // SYSYC_CONSTANTCONTEXT_H
@@ -13,6 +13,7 @@
 #include <iterator>
 #include <list>
 #include <map>
+#include <vector>
 
 #include "BasicBlock.h"
 #include "Module.h"
@@ -44,6 +45,21 @@ public:
    *
    */
   ~Function();
+  /**
+   * @brief 从模块内存池分配函数对象
+   *
+   * @param size 对象大小
+   * @param m 所属模块
+   * @return void* 对象起始地址
+   */
+  void *operator new(std::size_t size, Module *m) {
+    return Value::allocate(size, m, Arena::FunctionKind);
+  }
+  /**
+   * @brief 内存归模块内存池所有，不单独释放
+   *
+   */
+  void operator delete(void *) {}
   /**
    * @brief 创建函数对象
    *
@@ -117,13 +133,19 @@ public:
    *
    * @note 获取管理的基本块链第一个基本块
    */
-  BasicBlock *get_entry_block() { return *basic_blocks_.begin(); }
+  BasicBlock *get_entry_block() {
+    materialize();
+    return *basic_blocks_.begin();
+  }
   /**
    * @brief Get the basic blocks object，获取基本块链
    *
    * @return std::list<BasicBlock *>& 基本块链的引用
    */
-  std::list<BasicBlock *> &get_basic_blocks() { return basic_blocks_; }
+  std::list<BasicBlock *> &get_basic_blocks() {
+    materialize();
+    return basic_blocks_;
+  }
   /**
    * @brief Get the args object，获取参数列表
    *
@@ -136,29 +158,136 @@ public:
    * @return true 包含基本块
    * @return false 不包含基本块
    */
-  bool is_declaration() { return basic_blocks_.empty(); }
+  bool is_declaration() {
+    materialize();
+    return basic_blocks_.empty();
+  }
+  /**
+   * @brief 判断函数体是否尚未读取
+   *
+   * @return true 延迟加载的函数体尚未读取
+   * @return false 函数体已读取或函数为声明
+   */
+  bool is_materializable() const { return materializable_; }
+  /**
+   * @brief 读取延迟加载的函数体
+   *
+   * @return true 函数体已读取或无需读取
+   * @return false 函数体格式错误，函数保持为声明
+   * @note 访问基本块的接口会先调用本函数，首次访问时才读取函数体
+   * @note 读取时修改模块，不能在多个线程中同时读取同一模块的函数体
+   */
+  bool materialize() { return !materializable_ || materialize_body(); }
   /**
    * @brief Set the instr name object，为参数和基本块设置名称
    *
    */
   void set_instr_name();
+  /**
+   * @brief 为参数、基本块和指令分配函数内的稠密编号
+   *
+   * @note 参数编号即参数位置，基本块编号位于[0, 基本块数)，
+   * 指令编号按基本块顺序位于[0, 指令数)
+   * @note 编号有效时直接返回；增删基本块或指令后编号失效，需重新调用
+   * @note 分析可用编号索引平坦数组与位图，代替以指针为键的map
+   */
+  void compute_numbering();
+  /**
+   * @brief 判断当前编号是否有效
+   *
+   * @return true 编号与函数结构一致
+   * @return false 尚未编号或编号后函数被修改
+   */
+  bool has_numbering() const { return numbering_valid_; }
+  /**
+   * @brief 使编号失效
+   *
+   * @note 由基本块与指令的增删操作调用
+   */
+  void invalidate_numbering() { numbering_valid_ = false; }
+  /**
+   * @brief Get the num numbered blocks object，获取编号的基本块数
+   *
+   * @return unsigned 基本块编号的上界
+   */
+  unsigned get_num_numbered_blocks() const {
+    assert(numbering_valid_ && "function numbering is stale");
+    return num_numbered_bbs_;
+  }
+  /**
+   * @brief Get the num numbered instrs object，获取编号的指令数
+   *
+   * @return unsigned 指令编号的上界
+   */
+  unsigned get_num_numbered_instrs() const {
+    assert(numbering_valid_ && "function numbering is stale");
+    return num_numbered_instrs_;
+  }
+  /**
+   * @brief 为指令分配内存
+   *
+   * @param size 字节数，包含operand槽
+   * @return void* 内存起始地址
+   * @note 优先复用同一大小档位中已删除指令的内存，否则从模块内存池分配
+   */
+  void *allocate_instruction(std::size_t size);
+  /**
+   * @brief 回收已删除指令的内存
+   *
+   * @param mem 内存起始地址
+   * @param size 字节数，与分配时一致
+   */
+  void free_instruction(void *mem, std::size_t size);
   /**
    * @brief 打印函数
    *
-   * @return std::string 字符串
+   * @param os 输出流
+   */
+  void print_ir(OutStream &os) override;
+  /**
+   * @brief 判断value是否为函数
+   *
+   * @param v value指针
+   * @return true 是
+   * @return false 不是
    */
-  std::string print();
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::FunctionVal;
+  }
 
 private:
   std::list<BasicBlock *> basic_blocks_; // basic blocks
   std::list<Argument *> arguments_;      // arguments
   Module *parent_;
   unsigned seq_cnt_;
+  /// 函数体是否尚未从延迟加载的输入中读取
+  bool materializable_ = false;
+  /// 稠密编号是否有效及各类编号的个数
+  bool numbering_valid_ = false;
+  unsigned num_numbered_bbs_ = 0;
+  unsigned num_numbered_instrs_ = 0;
+  /// 空闲内存块，复用其首部存放链表指针
+  struct FreeNode {
+    FreeNode *next_;
+  };
+  /// 按大小档位(alignof(Use)字节一档)组织的空闲链表
+  std::vector<FreeNode *> free_lists_;
   /**
    * @brief 创建函数参数列表
    *
    */
   void build_args();
+  /**
+   * @brief 经所属模块的读取器读取函数体
+   *
+   * @return true 读取成功
+   * @return false 函数体格式错误
+   */
+  bool materialize_body();
+
+  /// 二进制中间代码读写时保存与恢复seq_cnt_，延迟加载时标记待读取的函数体
+  friend class IRWriter;
+  friend class IRReader;
 };
 
 /**
@@ -175,14 +304,29 @@ public:
    * @param f 所属函数
    * @param arg_no 参数列表中的位置
    */
-  explicit Argument(Type *ty, const std::string &name = "",
+  explicit Argument(Type *ty, std::string_view name = "",
                     Function *f = nullptr, unsigned arg_no = 0)
-      : Value(ty, name), parent_(f), arg_no_(arg_no) {}
+      : Value(ty, Value::ArgumentVal, name), parent_(f), arg_no_(arg_no) {}
   /**
    * @brief Destroy the Argument object，析构函数
    *
    */
   ~Argument() {}
+  /**
+   * @brief 从模块内存池分配参数对象
+   *
+   * @param size 对象大小
+   * @param m 所属模块
+   * @return void* 对象起始地址
+   */
+  void *operator new(std::size_t size, Module *m) {
+    return Value::allocate(size, m, Arena::ArgumentKind);
+  }
+  /**
+   * @brief 内存归模块内存池所有，不单独释放
+   *
+   */
+  void operator delete(void *) {}
   /**
    * @brief Get the parent object，获取参数所属函数
    *
@@ -200,7 +344,9 @@ public:
    *
    * @return Argument* ，获取新的参数对象指针
    */
-  Argument *deepcopy() { return new Argument(type_, name_, parent_, arg_no_); }
+  Argument *deepcopy() {
+    return new (type_->get_module()) Argument(type_, get_name(), parent_, arg_no_);
+  }
   /**
    * @brief Get the arg no object，获取参数列表参数个数
    *
@@ -214,9 +360,19 @@ public:
   /**
    * @brief 打印参数列表
    *
-   * @return std::string 字符串
+   * @param os 输出流
    */
-  virtual std::string print() override;
+  virtual void print_ir(OutStream &os) override;
+  /**
+   * @brief 判断value是否为函数参数
+   *
+   * @param v value指针
+   * @return true 是
+   * @return false 不是
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::ArgumentVal;
+  }
 
 private:
   Function *parent_;
@@ -10,15 +10,17 @@
 
 #include "Constant.h"
 #include "Module.h"
+#include "Span.h"
 #include "User.h"
 
 /*! 全局变量类，包含常量*/
 class GlobalVariable : public User {
 private:
   bool is_const_;      //<! 是否为常量
-  Constant *init_val_; //<! 初始值
-  std::vector<int>
-      _flatten_init_val; //<! 常量数组的存储数组(扁平化，多维数组降为一维)
+  Constant *init_val_; //<! 初始值，由扁平存储创建时按需构建嵌套视图
+  //<! 常量数组的存储数组(扁平化，多维数组降为一维)，位于模块内存池
+  mutable const int *flat_data_ = nullptr;
+  mutable std::size_t flat_size_ = 0; //<! 扁平存储的元素个数
   /*!
    *@brief 全局变量的构造函数
    *@param name 全局变量名称
@@ -31,6 +33,9 @@ private:
   GlobalVariable(std::string name, Module *m, Type *ty, bool is_const,
                  Constant *init = nullptr);
 
+  friend class IRWriter;
+  friend class IRReader;
+
 public:
   /*!
    *@brief 全局变量的创建函数
@@ -45,15 +50,41 @@ public:
                                 bool is_const, Constant *init);
 
   /*!
-   *@brief 全局变量的创建函数
+   *@brief 由扁平化初值创建全局数组
    *@param name 全局变量名称
    *@param m 所从属模块
-   *@param ty 变量的类型
+   *@param ty 变量的类型，须为int32数组
    *@param is_const 是否为常量
-   *@param init 常量指针
+   *@param flat 按行优先展平的初值
    *@return 当前对象本身
+   *@note 初值只在模块内存池保存一份，嵌套初值在首次get_init时构建
+   */
+  static GlobalVariable *create(std::string name, Module *m, ArrayType *ty,
+                                bool is_const, const std::vector<int> &flat);
+
+  /*!
+   *@brief 从模块内存池分配全局变量
+   *@param size 对象大小
+   *@param m 所从属模块
+   *@param num_ops operand个数，有初值时为1
+   *@return 对象起始地址，operand槽位于其前
+   */
+  void *operator new(std::size_t size, Module *m, unsigned num_ops) {
+    return User::allocate_with_operands(size, m, Arena::GlobalVariableKind,
+                                        num_ops);
+  }
+
+  /*!
+   *@brief 内存归模块内存池所有，不单独释放
    */
-  Constant *get_init() { return init_val_; }
+  void operator delete(void *) {}
+
+  /*!
+   *@brief 获取初值
+   *@return 嵌套初值，无初值时为空
+   *@note 由扁平存储创建的初值在首次调用时构建，各行直接引用扁平存储
+   */
+  Constant *get_init();
 
   /*!
    *@brief 判断是否是常量
@@ -65,19 +96,37 @@ public:
   /*!
    *@brief 扁平化数组的创建
    *@param i 常量化的扁平数组
+   *@note 有int32数组初值时替换为紧凑常量数组，扁平存储与初值只有一份
    */
-  void setFlattenInit(const std::vector<int> &i) { _flatten_init_val = i; }
+  void setFlattenInit(const std::vector<int> &i);
 
   /*!
    *@brief 获取扁平化数组
-   *@return 常量扁平化数组
+   *@return 常量扁平化数组的视图，随模块一并有效
+   *@note 初值为int32紧凑或稀疏常量数组且未单独设置时，直接取其元素
+   */
+  Span<int> getFlattenInit() const;
+
+  /*!
+   *@brief 由扁平化数组一次构建嵌套初值
+   *@return 全零时为ConstantZero，否则为嵌套常量数组
+   *@note 各行直接引用扁平存储，不复制
+   */
+  Constant *build_init_from_flatten() const;
+
+  /*!
+   *@brief 判断value是否为全局变量
+   *@param v value指针
+   *@return 判定结果
    */
-  std::vector<int> getFlattenInit() const { return _flatten_init_val; }
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::GlobalVariableVal;
+  }
 
   /*!
    *@brief 打印全局变量
-   *@return 字符串
+   *@param os 输出流
    */
-  std::string print();
+  void print_ir(OutStream &os) override;
 };
 #endif // SYSYC_GLOBALVARIABLE_H
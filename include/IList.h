@@ -0,0 +1,332 @@
+/*!
+ *@file IList.h
+ *@brief 侵入式双向链表接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_ILIST_H
+#define SYSYC_ILIST_H
+
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+
+template <typename T> class IList;
+
+/*!
+ *@brief 侵入式链表节点
+ *@note
+ *---------
+ *前驱与后继指针存放在元素自身中，一个元素同一时刻只能位于一个链表
+ */
+template <typename T> class IListNode {
+private:
+  T *prev_ = nullptr;  // 前驱元素
+  T *next_ = nullptr;  // 后继元素
+  unsigned order_ = 0; // 链表内的序号，由链表惰性维护
+
+  friend class IList<T>;
+
+public:
+  /*!
+   *@brief 获取链表中的前驱元素
+   *@return 元素指针，位于链表头时为空
+   */
+  T *get_prev() const { return prev_; }
+
+  /*!
+   *@brief 获取链表中的后继元素
+   *@return 元素指针，位于链表尾时为空
+   */
+  T *get_next() const { return next_; }
+};
+
+/*!
+ *@brief 侵入式双向链表
+ *@note
+ *---------
+ *不持有元素，插入、删除、移动均为O(1)，size为O(1)
+ *元素序号带间隔，插入时取前后序号的中点；间隔用尽时只标记失效，
+ *在下一次先后查询时整体重排，先后查询均摊O(1)
+ */
+template <typename T> class IList {
+private:
+  static constexpr unsigned OrderGap = 256; // 重排后相邻序号的间隔
+
+  T *head_ = nullptr;               // 链表头
+  T *tail_ = nullptr;               // 链表尾
+  std::size_t size_ = 0;            // 元素个数
+  mutable bool order_valid_ = true; // 元素序号是否有效
+
+  static IListNode<T> *node(T *v) { return v; }
+  static T *next_of(T *v) { return node(v)->next_; }
+  static T *prev_of(T *v) { return node(v)->prev_; }
+
+  /*!
+   *@brief 为新插入的元素分配序号
+   *@param v 已链入的元素
+   *@note 前后序号之间没有空位时标记序号失效
+   */
+  void assign_order(T *v) {
+    if (!order_valid_) {
+      return;
+    }
+    T *prev = node(v)->prev_;
+    T *next = node(v)->next_;
+    unsigned lo = prev ? node(prev)->order_ : 0;
+    if (next == nullptr) {
+      if (lo <= UINT_MAX - OrderGap) {
+        node(v)->order_ = lo + OrderGap;
+        return;
+      }
+    } else {
+      unsigned hi = node(next)->order_;
+      if (hi - lo > 1) {
+        node(v)->order_ = lo + (hi - lo) / 2;
+        return;
+      }
+    }
+    order_valid_ = false;
+  }
+
+  /*!
+   *@brief 按间隔重排所有元素的序号
+   */
+  void renumber() const {
+    unsigned order = 0;
+    for (T *v = head_; v != nullptr; v = next_of(v)) {
+      order += OrderGap;
+      node(v)->order_ = order;
+    }
+    order_valid_ = true;
+  }
+
+public:
+  /*! 双向迭代器，解引用得到元素指针*/
+  class iterator {
+  private:
+    T *cur_;
+    const IList *list_;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T **;
+    using reference = T *;
+
+    iterator(T *cur = nullptr, const IList *list = nullptr)
+        : cur_(cur), list_(list) {}
+    T *operator*() const { return cur_; }
+    iterator &operator++() {
+      cur_ = next_of(cur_);
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    iterator &operator--() {
+      cur_ = cur_ ? prev_of(cur_) : list_->tail_;
+      return *this;
+    }
+    iterator operator--(int) {
+      iterator tmp = *this;
+      --*this;
+      return tmp;
+    }
+    bool operator==(const iterator &rhs) const { return cur_ == rhs.cur_; }
+    bool operator!=(const iterator &rhs) const { return cur_ != rhs.cur_; }
+  };
+  using reverse_iterator = std::reverse_iterator<iterator>;
+
+  IList() = default;
+  IList(const IList &) = delete;
+  IList &operator=(const IList &) = delete;
+
+  iterator begin() const { return iterator(head_, this); }
+  iterator end() const { return iterator(nullptr, this); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+  bool empty() const { return head_ == nullptr; }
+  std::size_t size() const { return size_; }
+  T *front() const { return head_; }
+  T *back() const { return tail_; }
+
+  /*!
+   *@brief 获取元素对应的迭代器
+   *@param v 链表中的元素
+   *@return 迭代器
+   */
+  iterator iterator_to(T *v) const { return iterator(v, this); }
+
+  /*!
+   *@brief 在pos之前插入元素
+   *@param pos 插入位置，end()表示尾部
+   *@param v 不在任何链表中的元素
+   *@return 指向新元素的迭代器
+   */
+  iterator insert(iterator pos, T *v) {
+    T *next = *pos;
+    T *prev = next ? node(next)->prev_ : tail_;
+    node(v)->prev_ = prev;
+    node(v)->next_ = next;
+    if (prev) {
+      node(prev)->next_ = v;
+    } else {
+      head_ = v;
+    }
+    if (next) {
+      node(next)->prev_ = v;
+    } else {
+      tail_ = v;
+    }
+    size_++;
+    assign_order(v);
+    return iterator(v, this);
+  }
+
+  /*!
+   *@brief 在pos之前插入元素
+   *@param pos 链表中的元素
+   *@param v 不在任何链表中的元素
+   */
+  void insert_before(T *pos, T *v) { insert(iterator(pos, this), v); }
+
+  /*!
+   *@brief 在pos之后插入元素
+   *@param pos 链表中的元素
+   *@param v 不在任何链表中的元素
+   */
+  void insert_after(T *pos, T *v) {
+    insert(iterator(node(pos)->next_, this), v);
+  }
+
+  void push_back(T *v) { insert(end(), v); }
+  void push_front(T *v) { insert(begin(), v); }
+
+  /*!
+   *@brief 从链表中摘除元素
+   *@param v 链表中的元素
+   */
+  void remove(T *v) {
+    assert(size_ > 0 && "remove from an empty list");
+    T *prev = node(v)->prev_;
+    T *next = node(v)->next_;
+    if (prev) {
+      node(prev)->next_ = next;
+    } else {
+      head_ = next;
+    }
+    if (next) {
+      node(next)->prev_ = prev;
+    } else {
+      tail_ = prev;
+    }
+    node(v)->prev_ = nullptr;
+    node(v)->next_ = nullptr;
+    size_--;
+  }
+
+  /*!
+   *@brief 摘除迭代器指向的元素
+   *@param pos 迭代器
+   *@return 指向下一个元素的迭代器
+   */
+  iterator erase(iterator pos) {
+    T *next = node(*pos)->next_;
+    remove(*pos);
+    return iterator(next, this);
+  }
+
+  void pop_back() { remove(tail_); }
+  void pop_front() { remove(head_); }
+
+  /*!
+   *@brief 将other中[first, last)的元素移动到pos之前
+   *@param pos 本链表中的插入位置
+   *@param other 源链表，可以是本链表
+   *@param first 区间起点
+   *@param last 区间终点
+   *@note 同一链表内为O(1)；跨链表时需逐个计数区间长度，为O(n)，
+   *已知长度时应调用带计数的重载。本链表的序号标记失效
+   */
+  void splice(iterator pos, IList &other, iterator first, iterator last) {
+    std::size_t n = 0;
+    if (&other != this) {
+      for (iterator it = first; it != last; ++it) {
+        n++;
+      }
+    }
+    splice(pos, other, first, last, n);
+  }
+
+  /*!
+   *@brief 将other中[first, last)的n个元素移动到pos之前
+   *@param pos 本链表中的插入位置
+   *@param other 源链表，可以是本链表
+   *@param first 区间起点
+   *@param last 区间终点
+   *@param n 区间长度，由调用者给出，同一链表内时不使用
+   *@note 指针修改与计数更新均为O(1)，本链表的序号标记失效
+   */
+  void splice(iterator pos, IList &other, iterator first, iterator last,
+              std::size_t n) {
+    if (first == last) {
+      return;
+    }
+    T *first_v = *first;
+    T *last_v = last == other.end() ? other.tail_ : node(*last)->prev_;
+    // 从源链表摘下区间
+    T *before = node(first_v)->prev_;
+    T *after = node(last_v)->next_;
+    if (before) {
+      node(before)->next_ = after;
+    } else {
+      other.head_ = after;
+    }
+    if (after) {
+      node(after)->prev_ = before;
+    } else {
+      other.tail_ = before;
+    }
+    other.size_ -= n;
+    // 接入pos之前
+    T *next = *pos;
+    T *prev = next ? node(next)->prev_ : tail_;
+    node(first_v)->prev_ = prev;
+    node(last_v)->next_ = next;
+    if (prev) {
+      node(prev)->next_ = first_v;
+    } else {
+      head_ = first_v;
+    }
+    if (next) {
+      node(next)->prev_ = last_v;
+    } else {
+      tail_ = last_v;
+    }
+    size_ += n;
+    order_valid_ = false;
+  }
+
+  /*!
+   *@brief 判断a是否位于b之前
+   *@param a 链表中的元素
+   *@param b 链表中的元素
+   *@return 判定结果
+   *@note 序号失效时先重排，否则O(1)
+   */
+  bool comes_before(T *a, T *b) const {
+    if (!order_valid_) {
+      renumber();
+    }
+    return node(a)->order_ < node(b)->order_;
+  }
+};
+
+#endif // SYSYC_ILIST_H
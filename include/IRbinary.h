@@ -0,0 +1,345 @@
+/*!
+ *@file IRbinary.h
+ *@brief 二进制中间代码读写接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_IRBINARY_H
+#define SYSYC_IRBINARY_H
+
+#include "BasicBlock.h"
+#include "Constant.h"
+#include "Function.h"
+#include "GlobalVariable.h"
+#include "Instruction.h"
+#include "Module.h"
+#include "OutStream.h"
+#include "Type.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ *@brief 二进制中间代码格式
+ *@note
+ *---------
+ *文件依次为：魔数与版本、字符串表、类型表、常量表、全局量、函数声明、函数体；
+ *整数为LEB128变长编码，有符号数先做zigzag变换；
+ *类型与常量按依赖顺序排列，只引用排在前面的序号；
+ *紧凑常量数组与稀疏常量数组的元素按4字节小端原样存放，并按4字节对齐；
+ *函数体内的value依次编号为全局量、函数、常量、参数、基本块、指令，
+ *operand按当前指令序号减operand序号的相对值编码，近处的operand只占一个字节；
+ *每个函数体自成一段，函数声明中记录其长度，读取时可整段跳过
+ */
+struct IRBinaryFormat {
+  static constexpr char Magic[4] = {'S', 'Y', 'I', 'R'}; // 魔数
+  static constexpr unsigned Version = 1;                 // 格式版本
+
+  /*! 常量表中的常量种类*/
+  enum ConstantTag {
+    IntTag,
+    FPTag,
+    ZeroTag,
+    ArrayTag,
+    DataArrayTag,
+    SparseArrayTag,
+  };
+
+  /*! 全局量的标志位*/
+  enum GlobalFlag {
+    ConstFlag = 1,    // 常量全局量
+    InitFlag = 2,     // 有初值operand
+    LazyInitFlag = 4, // 嵌套初值由扁平存储按需构建
+    FlatInitFlag = 8, // 另存由setFlattenInit设置的扁平初值
+  };
+};
+
+/*!
+ *@brief 二进制中间代码写出器
+ *@note
+ *---------
+ *先遍历模块为类型、常量与名称编号，再依次写出各表；
+ *类型与常量已在模块内唯一化，按指针编号即可去重；
+ *各指令类的operand与附加字段均完整保存，读回后打印结果与原模块相同
+ */
+class IRWriter {
+private:
+  Module *m_; // 待写出的模块
+
+  std::unordered_map<std::string_view, unsigned> string_ids_; // 名称的序号
+  std::vector<std::string_view> strings_;                     // 字符串表
+  std::unordered_map<Type *, unsigned> type_ids_;             // 类型的序号
+  std::vector<Type *> types_;                                 // 类型表
+  std::unordered_map<Constant *, unsigned> const_ids_;        // 常量的序号
+  std::vector<Constant *> consts_;                            // 常量表
+  std::unordered_map<Value *, unsigned> global_ids_; // 全局量与函数的序号
+
+  /*!
+   *@brief 登记名称
+   *@param v value指针
+   */
+  void add_name(Value *v);
+  /*!
+   *@brief 登记类型及其组成类型
+   *@param ty 类型指针
+   */
+  void add_type(Type *ty);
+  /*!
+   *@brief 登记常量及其元素
+   *@param c 常量指针
+   */
+  void add_constant(Constant *c);
+  /*!
+   *@brief 登记函数体中的类型、常量与名称
+   *@param f 函数指针
+   */
+  void add_function_body(Function *f);
+
+  /*!
+   *@brief 获取名称的引用
+   *@param v value指针
+   *@return 字符串表序号加1，无名称时为0
+   */
+  unsigned get_name_ref(Value *v) const;
+  /*!
+   *@brief 获取类型的序号
+   *@param ty 类型指针
+   *@return 类型表序号
+   */
+  unsigned get_type_id(Type *ty) const { return type_ids_.at(ty); }
+
+  /*!
+   *@brief 依次写出各表
+   *@param out 目标字节串，起点即文件起点
+   */
+  void write_types(std::string &out) const;
+  void write_constants(std::string &out) const;
+  void write_globals(std::string &out);
+  /*!
+   *@brief 写出函数体
+   *@param out 目标字节串
+   *@param f 函数指针，须有基本块
+   */
+  void write_function_body(std::string &out, Function *f);
+
+public:
+  /*!
+   *@brief 写出器构造函数
+   *@param m 待写出的模块
+   */
+  explicit IRWriter(Module *m) : m_(m) {}
+
+  IRWriter(const IRWriter &) = delete;
+  IRWriter &operator=(const IRWriter &) = delete;
+
+  /*!
+   *@brief 将模块写出到输出流
+   *@param os 输出流，如写入文件的FdOutStream
+   *@note 函数体会按需计算稠密编号
+   */
+  void write(OutStream &os);
+
+  /*!
+   *@brief 将模块写出为字节串
+   *@param m 模块
+   *@return 二进制中间代码
+   */
+  static std::string write(Module *m);
+};
+
+/*!
+ *@brief 二进制中间代码读取器
+ *@note
+ *---------
+ *输入须在读取期间保持有效；格式错误或序号越界时读取失败，不会越界访问；
+ *函数体先按记录创建空operand槽的指令，再统一填入operand，
+ *因此phi等可引用排在后面的指令；跳转目标按原模块中前置基本块的顺序挂链，
+ *读回的CFG与原模块一致；
+ *延迟加载时读取器归模块所有，函数体与整数、浮点常量在首次访问时才读取
+ */
+class IRReader {
+private:
+  const unsigned char *begin_; // 输入起始
+  const unsigned char *end_;   // 输入结束
+  const unsigned char *cur_;   // 读取位置
+  bool error_ = false;         // 是否遇到格式错误
+
+  Module *m_ = nullptr;                 // 正在构建的模块
+  std::vector<std::string_view> strings_; // 字符串表，指向输入
+  std::vector<Type *> types_;             // 类型表
+  std::vector<Constant *> consts_;        // 常量表，延迟加载时暂未创建的为空
+  std::vector<const unsigned char *> const_records_; // 延迟加载时各项常量的位置
+  std::vector<Value *> globals_;          // 全局量与函数，按声明顺序
+
+  /*! 函数体在输入中的位置*/
+  struct BodyRange {
+    Function *func_;
+    const unsigned char *begin_;
+    const unsigned char *end_;
+  };
+  std::vector<BodyRange> bodies_; // 有函数体的函数
+  std::unordered_map<Function *, BodyRange> pending_; // 延迟加载时尚未读取的函数体
+  bool lazy_ = false; // 延迟加载，输入归模块所有，常量与函数体按需读取
+
+  /*!
+   *@brief 记录格式错误
+   *@return 恒为false
+   */
+  bool fail() {
+    error_ = true;
+    return false;
+  }
+
+  /*!
+   *@brief 读取LEB128变长编码的无符号数
+   *@return 读取的数，越界时记录错误并返回0
+   */
+  std::uint64_t read_varint();
+  /*!
+   *@brief 读取zigzag变换后的有符号数
+   *@return 读取的数
+   */
+  std::int64_t read_signed() {
+    std::uint64_t v = read_varint();
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+  }
+  /*!
+   *@brief 读取不超过上限的无符号数
+   *@param limit 上限，不含
+   *@return 读取的数，越界时记录错误并返回0
+   */
+  unsigned read_index(std::size_t limit);
+  /*!
+   *@brief 读取按4字节对齐存放的原始字节
+   *@param bytes 字节数
+   *@return 起始位置，越界时为空
+   */
+  const unsigned char *read_aligned(std::size_t bytes);
+
+  /*!
+   *@brief 读取名称引用
+   *@return 名称，无名称或越界时为空
+   */
+  std::string_view read_name();
+  /*!
+   *@brief 读取类型序号
+   *@return 类型指针，越界时为空
+   */
+  Type *read_type();
+  /*!
+   *@brief 读取常量序号
+   *@return 常量指针，越界时为空
+   */
+  Constant *read_constant_ref();
+  /*!
+   *@brief 获取常量，延迟加载时首次引用才创建
+   *@param id 常量表序号，须未越界
+   *@return 常量指针
+   */
+  Constant *get_constant(unsigned id);
+
+  /*!
+   *@brief 读取常量表中的一项
+   *@param defer_scalar 是否只校验整数与浮点常量而暂不创建
+   *@return 常量指针，暂不创建或格式错误时为空
+   */
+  Constant *read_constant(bool defer_scalar);
+  /*!
+   *@brief 依次读取各表
+   *@return 是否成功
+   */
+  bool read_header();
+  bool read_strings();
+  bool read_types();
+  bool read_constants();
+  bool read_globals();
+  bool read_functions();
+  /*!
+   *@brief 读取函数体
+   *@param range 函数与函数体的位置
+   *@return 是否成功
+   */
+  bool read_function_body(const BodyRange &range);
+  /*!
+   *@brief 校验指令的operand与类型
+   *@param instr 已填入operand的指令
+   *@param f 所属函数
+   *@return 是否合法
+   */
+  bool verify_instruction(Instruction *instr, Function *f);
+  /*!
+   *@brief 创建模块并读取函数体之外的各表
+   *@param name 模块名称
+   *@return 是否成功，失败时模块已析构
+   */
+  bool read_declarations(const std::string &name);
+
+public:
+  /*!
+   *@brief 读取器构造函数
+   *@param data 二进制中间代码
+   *@param size 字节数
+   */
+  IRReader(const void *data, std::size_t size)
+      : begin_(static_cast<const unsigned char *>(data)),
+        end_(begin_ + size), cur_(begin_) {}
+
+  IRReader(const IRReader &) = delete;
+  IRReader &operator=(const IRReader &) = delete;
+
+  /*!
+   *@brief 读取模块
+   *@param name 模块名称
+   *@return 新建的模块，格式错误时为空
+   */
+  Module *read_module(const std::string &name);
+
+  /*!
+   *@brief 判断是否遇到格式错误
+   *@return 判定结果
+   */
+  bool has_error() const { return error_; }
+
+  /*!
+   *@brief 从字节串读取模块
+   *@param data 二进制中间代码
+   *@param name 模块名称
+   *@return 新建的模块，格式错误时为空
+   */
+  static Module *read(std::string_view data, const std::string &name);
+
+  /*!
+   *@brief 从文件读取模块
+   *@param path 文件路径
+   *@param name 模块名称
+   *@return 新建的模块，打开失败或格式错误时为空
+   */
+  static Module *read_file(const std::string &path, const std::string &name);
+
+  /*!
+   *@brief 读取延迟加载的函数体
+   *@param f 函数体尚未读取的函数
+   *@return 是否成功，失败时函数保持为声明
+   */
+  bool materialize(Function *f);
+
+  /*!
+   *@brief 映射文件并延迟加载模块
+   *@param path 文件路径
+   *@param name 模块名称
+   *@return 新建的模块，打开、映射失败或格式错误时为空
+   *@note
+   *---------
+   *只读取类型、常量、全局量与函数声明，函数体在首次访问基本块时才读取；
+   *映射归模块所有，紧凑常量数组直接引用映射中的元素；
+   *函数体的格式错误在读取该函数体时才发现
+   */
+  static Module *load_file(const std::string &path, const std::string &name);
+};
+
+#endif // SYSYC_IRBINARY_H
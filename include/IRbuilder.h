@@ -10,15 +10,55 @@ private:
   BasicBlock *BB_;
   Module *m_;
   Function *curfunc;
+  bool fold_; //<! 是否折叠常量并化简代数恒等式
+
+  /*!
+   *@brief 折叠整数二元运算
+   *@param op 运算类型
+   *@param lhs 左值指针
+   *@param rhs 右值指针
+   *@return 可折叠时为常量或已有操作数，否则为空
+   */
+  Value *fold_binary(Instruction::OpID op, Value *lhs, Value *rhs);
+  /*!
+   *@brief 折叠整数比较
+   *@param op 比较类型
+   *@param lhs 左值指针
+   *@param rhs 右值指针
+   *@return 可折叠时为布尔常量，否则为空
+   */
+  Value *fold_cmp(CmpInst::CmpOp op, Value *lhs, Value *rhs);
+  /*!
+   *@brief 创建整数二元运算，折叠模式下先尝试折叠
+   *@param op 运算类型
+   *@param lhs 左值指针
+   *@param rhs 右值指针
+   *@return 折叠结果或新建的指令
+   */
+  Value *create_binary(Instruction::OpID op, Value *lhs, Value *rhs);
+  /*!
+   *@brief 创建整数比较，折叠模式下先尝试折叠
+   *@param op 比较类型
+   *@param lhs 左值指针
+   *@param rhs 右值指针
+   *@return 折叠结果或新建的指令
+   */
+  Value *create_cmp(CmpInst::CmpOp op, Value *lhs, Value *rhs);
 
 public:
   /*!
    *@brief irbuilder的构造函数
    *@param bb 基本块
    *@param m 模块
+   *@param fold 是否开启折叠模式
    *@return 当前对象本身
+   *@note
+   *---------
+   *折叠模式下，操作数均为整数常量的运算与比较直接返回唯一化的常量，
+   *x+0、x-0、x*1、x/1返回x，x*0、x-x、x%1返回0，不插入指令
    */
-  IRBuilder(BasicBlock *bb, Module *m) : BB_(bb), m_(m){};
+  IRBuilder(BasicBlock *bb, Module *m, bool fold = false)
+      : BB_(bb), m_(m), fold_(fold){};
   /*!
    *@brief irbuilder的析构函数
    */
@@ -43,6 +83,16 @@ public:
    *@return 基本块指针
    */
   BasicBlock *get_insert_block() { return this->BB_; }
+  /*!
+   *@brief 设置折叠模式
+   *@param fold 是否折叠常量并化简代数恒等式
+   */
+  void set_folding(bool fold) { fold_ = fold; }
+  /*!
+   *@brief 判断是否处于折叠模式
+   *@return 折叠模式判定结果
+   */
+  bool is_folding() const { return fold_; }
   /*!
    *@brief 更新要进行修改的基本块
    *@param bb 基本块指针
@@ -55,11 +105,11 @@ public:
    *@brief 创建加法指令
    *@param lhs 左值指针
    *@param rhs 右值指针
-   *@return 二元操作符加法指令指针
+   *@return 二元操作符加法指令指针，折叠时为常量或操作数
    *@note 调用指针类的创建函数
    */
-  BinaryInst *create_iadd(Value *lhs, Value *rhs) {
-    return BinaryInst::create_add(lhs, rhs, this->BB_, m_);
+  Value *create_iadd(Value *lhs, Value *rhs) {
+    return create_binary(Instruction::add, lhs, rhs);
   } //创建加法指令（以及其他算术指令）
   /*!
    *@brief 创建减法指令
@@ -68,8 +118,8 @@ public:
    *@return 二元操作符减法指令指针
    *@note 调用指针类的创建函数
    */
-  BinaryInst *create_isub(Value *lhs, Value *rhs) {
-    return BinaryInst::create_sub(lhs, rhs, this->BB_, m_);
+  Value *create_isub(Value *lhs, Value *rhs) {
+    return create_binary(Instruction::sub, lhs, rhs);
   }
   /*!
    *@brief 创建乘法指令
@@ -78,8 +128,8 @@ public:
    *@return 二元操作符乘法指令指针
    *@note 调用指针类的创建函数
    */
-  BinaryInst *create_imul(Value *lhs, Value *rhs) {
-    return BinaryInst::create_mul(lhs, rhs, this->BB_, m_);
+  Value *create_imul(Value *lhs, Value *rhs) {
+    return create_binary(Instruction::mul, lhs, rhs);
   }
   /*!
    *@brief 创建除法指令
@@ -88,8 +138,8 @@ public:
    *@return 二元操作符除法指令指针
    *@note 调用指针类的创建函数
    */
-  BinaryInst *create_isdiv(Value *lhs, Value *rhs) {
-    return BinaryInst::create_sdiv(lhs, rhs, this->BB_, m_);
+  Value *create_isdiv(Value *lhs, Value *rhs) {
+    return create_binary(Instruction::sdiv, lhs, rhs);
   }
   /*!
    *@brief 创建模运算指令
@@ -98,8 +148,8 @@ public:
    *@return 二元操作符模运算指令指针
    *@note 调用指针类的创建函数
    */
-  BinaryInst *create_irem(Value *lhs, Value *rhs) {
-    return BinaryInst::create_mod(lhs, rhs, this->BB_, m_);
+  Value *create_irem(Value *lhs, Value *rhs) {
+    return create_binary(Instruction::mod, lhs, rhs);
   }
   /*!
    *@brief 创建与运算指令
@@ -129,8 +179,8 @@ public:
    *@note 调用指针类的创建函数
    */
 
-  CmpInst *create_icmp_eq(Value *lhs, Value *rhs) {
-    return CmpInst::create_cmp(CmpInst::EQ, lhs, rhs, this->BB_, m_);
+  Value *create_icmp_eq(Value *lhs, Value *rhs) {
+    return create_cmp(CmpInst::EQ, lhs, rhs);
   }
   /*!
    *@brief 创建比较不等指令
@@ -139,8 +189,8 @@ public:
    *@return 二元操作符不等指令指针
    *@note 调用指针类的创建函数
    */
-  CmpInst *create_icmp_ne(Value *lhs, Value *rhs) {
-    return CmpInst::create_cmp(CmpInst::NE, lhs, rhs, this->BB_, m_);
+  Value *create_icmp_ne(Value *lhs, Value *rhs) {
+    return create_cmp(CmpInst::NE, lhs, rhs);
   }
   /*!
    *@brief 创建比较大于等于指令
@@ -149,8 +199,8 @@ public:
    *@return 二元操作符大于等于指令指针
    *@note 调用指针类的创建函数
    */
-  CmpInst *create_icmp_gt(Value *lhs, Value *rhs) {
-    return CmpInst::create_cmp(CmpInst::GT, lhs, rhs, this->BB_, m_);
+  Value *create_icmp_gt(Value *lhs, Value *rhs) {
+    return create_cmp(CmpInst::GT, lhs, rhs);
   }
   /*!
    *@brief 创建比较大于指令
@@ -160,8 +210,8 @@ public:
    *@note 调用指针类的创建函数
    */
 
-  CmpInst *create_icmp_ge(Value *lhs, Value *rhs) {
-    return CmpInst::create_cmp(CmpInst::GE, lhs, rhs, this->BB_, m_);
+  Value *create_icmp_ge(Value *lhs, Value *rhs) {
+    return create_cmp(CmpInst::GE, lhs, rhs);
   }
   /*!
    *@brief 创建比较小于指令
@@ -170,8 +220,8 @@ public:
    *@return 二元操作符比较小于指令指针
    *@note 调用指针类的创建函数
    */
-  CmpInst *create_icmp_lt(Value *lhs, Value *rhs) {
-    return CmpInst::create_cmp(CmpInst::LT, lhs, rhs, this->BB_, m_);
+  Value *create_icmp_lt(Value *lhs, Value *rhs) {
+    return create_cmp(CmpInst::LT, lhs, rhs);
   }
   /*!
    *@brief 创建比较小于等于指令
@@ -180,8 +230,8 @@ public:
    *@return 二元操作符比较小于指令指针
    *@note 调用指针类的创建函数
    */
-  CmpInst *create_icmp_le(Value *lhs, Value *rhs) {
-    return CmpInst::create_cmp(CmpInst::LE, lhs, rhs, this->BB_, m_);
+  Value *create_icmp_le(Value *lhs, Value *rhs) {
+    return create_cmp(CmpInst::LE, lhs, rhs);
   }
   /*!
    *@brief 创建调用指令
@@ -191,8 +241,8 @@ public:
    *@note 调用指针类的创建函数
    */
   CallInst *create_call(Value *func, std::vector<Value *> args) {
-    assert(dynamic_cast<Function *>(func) && "func must be Function * type");
-    return CallInst::create(static_cast<Function *>(func), args, this->BB_);
+    assert(isa<Function>(func) && "func must be Function * type");
+    return CallInst::create(cast<Function>(func), args, this->BB_);
   }
   /*!
    *@brief 创建无条件跳转指令
@@ -30,6 +30,14 @@
  */
 std::string print_as_op(Value *v, bool print_ty);
 
+/*!
+ *@brief 将operand的名称打印到输出流
+ *@param os 输出流
+ *@param v operand
+ *@param print_ty 是否先打印类型
+ */
+void print_as_op(OutStream &os, Value *v, bool print_ty);
+
 /*!
  *@brief 打印比较operands的名称
  *@return 字符串
@@ -9,6 +9,7 @@
 #define SYSYC_INSTRUCTION_H
 
 #include "BasicBlock.h"
+#include "IList.h"
 #include "Type.h"
 #include "User.h"
 #include "cassert"
@@ -17,7 +18,7 @@
 class BasicBlock;
 class Function;
 
-class Instruction : public User {
+class Instruction : public User, public IListNode<Instruction> {
 public:
   enum OpID {
     // Terminator Instructions
@@ -45,25 +46,36 @@ public:
   // ty here is result type
   Instruction(Type *ty, OpID id, unsigned num_ops, BasicBlock *parent);
   Instruction(Type *ty, OpID id, unsigned num_ops);
+  // 经所在函数分配，优先复用已删除指令的内存；operand槽定长、与对象一起分配
+  void *operator new(std::size_t size, BasicBlock *bb, unsigned num_ops);
+  // 经所在函数分配，优先复用已删除指令的内存；operand槽独立分配、可增长
+  void *operator new(std::size_t size, BasicBlock *bb, HungOffTag);
+  // 内存由erase_from_parent归还函数的空闲链表，或随模块内存池释放
+  void operator delete(void *) {}
   inline const BasicBlock *get_parent() const { return parent_; }
   inline BasicBlock *get_parent() { return parent_; }
-  void set_parent(BasicBlock *parent) { this->parent_ = parent; }
+  // 修改所在基本块；跳转指令已挂链的目标随之迁移前置基本块
+  void set_parent(BasicBlock *parent);
   // Return the function this instruction belongs to.
   Function *get_function();
   Module *get_module();
+  // 从所在基本块中删除并析构，内存归还所在函数的空闲链表
+  // 调用前指令不应再被使用，需先replace_all_use_with
+  void erase_from_parent();
 
   /// ============= FUNCTION CONTEXT IN SUBROUTINE ================
-  ///              维护一个基本块内的指令关系链，用于优化处理
-
-private:
-  Instruction *_prev_inst = nullptr;
-  Instruction *_next_inst = nullptr;
-
-public:
-  Instruction *getPrevInst() const { return _prev_inst; }
-  Instruction *getSuccInst() const { return _next_inst; }
-  void setPrevInst(Instruction *inst) { _prev_inst = inst; }
-  void setSuccInst(Instruction *inst) { _next_inst = inst; }
+  ///              基本块内的指令关系链即基本块的侵入式指令链表，用于优化处理
+
+  Instruction *getPrevInst() const { return get_prev(); }
+  Instruction *getSuccInst() const { return get_next(); }
+  // 从当前基本块移动到pos之前，pos可以位于其他基本块，O(1)
+  void move_before(Instruction *pos);
+  // 从当前基本块移动到pos之后，pos可以位于其他基本块，O(1)
+  void move_after(Instruction *pos);
+  // 判断本指令是否位于同一基本块中的other之前，均摊O(1)
+  bool comes_before(const Instruction *other) const;
+  // 函数内的稠密编号，需所在函数先compute_numbering
+  unsigned get_number() const;
 
   /// ============= INLINE OPTIMIZATION HELPER FUNCTIONS ==============
 
@@ -71,28 +83,28 @@ public:
   virtual Instruction *deepcopy(BasicBlock *parent) = 0;
   // 利用map映射替换指令内部所有指针到新值
   virtual void transplant(std::map<Value *, Value *> ptMap) {
-    // 替换UseList
-    auto it = use_list_.begin();
-    auto ite = use_list_.end();
-    while (it != ite) {
-      auto u = *it;
-      if (ptMap.find(u.val_) != ptMap.end()) {
-        *it = Use(ptMap[u.val_], u.arg_no_);
+    // 替换Operands，use链随之更新
+    for (unsigned i = 0; i < get_num_operand(); i++) {
+      auto it = ptMap.find(get_operand(i));
+      if (it != ptMap.end()) {
+        set_operand(i, it->second);
       }
-      it++;
     }
-    // 替换Operands
-    auto it1 = operands_.begin();
-    auto ite1 = operands_.end();
-    while (it1 != ite1) {
-      auto o = *it1;
-      if (ptMap.find(o) != ptMap.end()) {
-        *it1 = ptMap[o];
+  };
+
+protected:
+  // 复制另一条指令的operands，并挂入对应value的use链
+  void copy_operands(Instruction *from) {
+    for (unsigned i = 0; i < from->get_num_operand(); i++) {
+      if (i < get_num_operand()) {
+        set_operand(i, from->get_operand(i));
+      } else {
+        add_operand(from->get_operand(i));
       }
-      it1++;
     }
-  };
+  }
 
+public:
   /// ============= INLINE OPTIMIZATION HELPER FUNCTIONS ==============
 
   OpID get_instr_type() { return op_id_; }
@@ -182,10 +194,24 @@ public:
 
   bool isTerminator() { return is_br() || is_ret(); }
 
+  // 按子类型ID判定，供isa/cast/dyn_cast使用
+  static bool classof(const Value *v) {
+    return v->get_value_id() >= Value::InstructionVal;
+  }
+
+  // phi与call的operand槽独立分配、可增长，其余指令operand定长且与对象一起分配
+  static bool is_hung_off_op(OpID id) { return id == phi || id == call; }
+
+private:
+  // 按指令类型获取对象大小，不含operand槽
+  std::size_t get_object_size() const;
+
+  friend class Function;
+
 protected:
   BasicBlock *parent_;
   OpID op_id_;
-  unsigned num_ops_;
+  unsigned number_ = 0; // 函数内的稠密编号，由Function::compute_numbering分配
 };
 
 class BinaryInst : public Instruction {
@@ -193,6 +219,9 @@ private:
   BinaryInst(Type *ty, OpID id, Value *v1, Value *v2, BasicBlock *bb);
   BinaryInst(Type *ty, OpID id, BasicBlock *bb) : Instruction(ty, id, 2, bb){};
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   // create add instruction, auto insert to bb
   static BinaryInst *create_add(Value *v1, Value *v2, BasicBlock *bb,
@@ -221,24 +250,28 @@ public:
 
   virtual BinaryInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    BinaryInst *newInst = new BinaryInst(type_, op_id_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    BinaryInst *newInst = new (parent, 2) BinaryInst(type_, op_id_, parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() >= Value::InstructionVal + Instruction::add &&
+           v->get_value_id() <= Value::InstructionVal + Instruction::mod;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   int calculate() final;
 
+  // 按指令类型计算两个整数常量，加减乘按补码回绕，除零得0
+  static int calculate(OpID op, int cl, int cr);
+
+  // 右操作数为cr时是否可在编译期计算，除零与除以-1不折叠
+  static bool is_foldable(OpID op, int cr);
+
   bool isStaticCalculable() final;
 
 private:
@@ -246,6 +279,9 @@ private:
 };
 
 class CmpInst : public Instruction {
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   enum CmpOp {
     EQ, // ==
@@ -271,23 +307,23 @@ public:
 
   int calculate() final;
 
+  // 按比较类型计算两个整数常量，结果为0或1
+  static int calculate(CmpOp op, int cl, int cr);
+
   virtual CmpInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    CmpInst *newInst = new CmpInst(type_, cmp_op_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    CmpInst *newInst = new (parent, 2) CmpInst(type_, cmp_op_, parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::cmp;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
 private:
   CmpOp cmp_op_;
@@ -302,47 +338,36 @@ protected:
   CallInst(Type *typ, size_t sz, BasicBlock *bb)
       : Instruction(typ, Instruction::call, sz, bb){};
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static CallInst *create(Function *func, std::vector<Value *> args,
                           BasicBlock *bb);
   FunctionType *get_function_type() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::call;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual CallInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    CallInst *newInst = new CallInst(type_, operands_.size(), parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    CallInst *newInst =
+        new (parent, hung_off) CallInst(type_, get_num_operand(), parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 
   virtual void transplant(std::map<Value *, Value *> ptMap) override {
-    // 替换UseList
-    auto it = use_list_.begin();
-    auto ite = use_list_.end();
-    while (it != ite) {
-      auto u = *it;
-      if (ptMap.find(u.val_) != ptMap.end()) {
-        *it = Use(ptMap[u.val_], u.arg_no_);
-      }
-    }
     // 替换Operands，跳过第一个。第一个为函数指针，无需处理
-    auto it1 = operands_.begin();
-    auto ite1 = operands_.end();
-    it1++;
-    while (it1 != ite1) {
-      auto o = *it1;
-      if (ptMap.find(o) != ptMap.end()) {
-        *it1 = ptMap[o];
+    for (unsigned i = 1; i < get_num_operand(); i++) {
+      auto it = ptMap.find(get_operand(i));
+      if (it != ptMap.end()) {
+        set_operand(i, it->second);
       }
     }
   };
@@ -355,6 +380,9 @@ private:
   BranchInst(BasicBlock *if_true, BasicBlock *bb);
   BranchInst(int op_num, BasicBlock *bb);
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static BranchInst *create_cond_br(Value *cond, BasicBlock *if_true,
                                     BasicBlock *if_false, BasicBlock *bb);
@@ -370,21 +398,19 @@ public:
   BasicBlock *getTrueBB() const;
   BasicBlock *getFalseBB() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::br;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual BranchInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    BranchInst *newInst = new BranchInst(num_ops_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    BranchInst *newInst =
+        new (parent, get_num_operand()) BranchInst(get_num_operand(), parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 };
@@ -395,26 +421,27 @@ private:
   ReturnInst(BasicBlock *bb);
   ReturnInst(BasicBlock *bb, size_t num_op);
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static ReturnInst *create_ret(Value *val, BasicBlock *bb);
   static ReturnInst *create_void_ret(BasicBlock *bb);
   bool is_void_ret() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::ret;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual ReturnInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    ReturnInst *newInst = new ReturnInst(parent, num_ops_);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    ReturnInst *newInst =
+        new (parent, get_num_operand()) ReturnInst(parent, get_num_operand());
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 };
@@ -422,32 +449,36 @@ public:
 class GetElementPtrInst : public Instruction {
 private:
   GetElementPtrInst(Value *ptr, std::vector<Value *> idxs, BasicBlock *bb);
+  // ty为元素类型，指令类型为指向元素的指针
   GetElementPtrInst(Type *ty, size_t op_num, BasicBlock *bb)
-      : Instruction(ty, Instruction::getelementptr, op_num, bb),
+      : Instruction(PointerType::get(ty), Instruction::getelementptr, op_num,
+                    bb),
         element_ty_(ty){};
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static Type *get_element_type(Value *ptr, std::vector<Value *> idxs);
   static GetElementPtrInst *create_gep(Value *ptr, std::vector<Value *> idxs,
                                        BasicBlock *bb);
   Type *get_element_type() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() ==
+           Value::InstructionVal + Instruction::getelementptr;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual GetElementPtrInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
     GetElementPtrInst *newInst =
-        new GetElementPtrInst(element_ty_, num_ops_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+        new (parent, get_num_operand())
+            GetElementPtrInst(element_ty_, get_num_operand(), parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 
@@ -460,27 +491,27 @@ private:
   StoreInst(Value *val, Value *ptr, BasicBlock *bb);
   StoreInst(BasicBlock *bb);
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static StoreInst *create_store(Value *val, Value *ptr, BasicBlock *bb);
 
   Value *get_rval() { return this->get_operand(0); }
   Value *get_lval() { return this->get_operand(1); }
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::store;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual StoreInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    StoreInst *newInst = new StoreInst(parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    StoreInst *newInst = new (parent, 2) StoreInst(parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 };
@@ -491,27 +522,27 @@ private:
   LoadInst(Type *ty, BasicBlock *bb)
       : Instruction(ty, Instruction::load, 1, bb){};
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static LoadInst *create_load(Type *ty, Value *ptr, BasicBlock *bb);
   Value *get_lval() { return this->get_operand(0); }
 
   Type *get_load_type() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::load;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual LoadInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    LoadInst *newInst = new LoadInst(type_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    LoadInst *newInst = new (parent, 1) LoadInst(type_, parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 };
@@ -520,22 +551,24 @@ class AllocaInst : public Instruction {
 private:
   AllocaInst(Type *ty, BasicBlock *bb);
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static AllocaInst *create_alloca(Type *ty, BasicBlock *bb);
 
   Type *get_alloca_type() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::alloca;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual AllocaInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    AllocaInst *newInst = new AllocaInst(alloca_ty_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    newInst->operands_.clear();
+    AllocaInst *newInst = new (parent, 0) AllocaInst(alloca_ty_, parent);
     return newInst;
   };
   void set_init() { init = true; }
@@ -543,7 +576,7 @@ public:
 
 private:
   Type *alloca_ty_;
-  bool init;
+  bool init = false;
 };
 
 // 位扩展指令
@@ -553,26 +586,26 @@ private:
   ZextInst(Type *ty, BasicBlock *bb)
       : Instruction(ty, Instruction::zext, 1, bb), dest_ty_(ty){};
 
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
+
 public:
   static ZextInst *create_zext(Value *val, Type *ty, BasicBlock *bb);
 
   Type *get_dest_type() const;
 
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::zext;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual ZextInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    ZextInst *newInst = new ZextInst(type_, parent);
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    ZextInst *newInst = new (parent, 1) ZextInst(type_, parent);
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 
@@ -586,7 +619,10 @@ private:
           Type *ty, BasicBlock *bb);
   PhiInst(Type *ty, unsigned num_ops, BasicBlock *bb)
       : Instruction(ty, Instruction::phi, num_ops, bb) {}
-  Value *l_val_;
+  Value *l_val_ = nullptr;
+
+  // 读取二进制中间代码时先创建空operand槽的指令
+  friend class IRReader;
 
 public:
   static PhiInst *create_phi(Type *ty, BasicBlock *bb);
@@ -604,44 +640,25 @@ public:
       }
     }
   }
-  virtual std::string print() override;
+  static bool classof(const Value *v) {
+    return v->get_value_id() == Value::InstructionVal + Instruction::phi;
+  }
+
+  // 打印到输出流，不含行首缩进与换行
+  virtual void print_ir(OutStream &os) override;
 
   virtual PhiInst *deepcopy(BasicBlock *parent) override {
     // 复制基本信息
-    PhiInst *newInst = new PhiInst(type_, num_ops_, parent);
+    PhiInst *newInst = new (parent, hung_off) PhiInst(type_, 0, parent);
     newInst->l_val_ = l_val_;
-    // 复制UseList
-    newInst->use_list_.clear();
-    for (auto u : use_list_) {
-      newInst->use_list_.push_back(u);
-    }
-    // 复制Operands
-    newInst->operands_.clear();
-    for (auto o : operands_) {
-      newInst->operands_.push_back(o);
-    }
+    // 复制Operands，新指令的use节点挂入各operand的use链
+    newInst->copy_operands(this);
     return newInst;
   };
 
   virtual void transplant(std::map<Value *, Value *> ptMap) override {
-    // 替换UseList
-    auto it = use_list_.begin();
-    auto ite = use_list_.end();
-    while (it != ite) {
-      auto u = *it;
-      if (ptMap.find(u.val_) != ptMap.end()) {
-        *it = Use(ptMap[u.val_], u.arg_no_);
-      }
-    }
     // 替换Operands
-    auto it1 = operands_.begin();
-    auto ite1 = operands_.end();
-    while (it1 != ite1) {
-      auto o = *it1;
-      if (ptMap.find(o) != ptMap.end()) {
-        *it1 = ptMap[o];
-      }
-    }
+    Instruction::transplant(ptMap);
     // 替换lval
     if (ptMap.find(l_val_) != ptMap.end())
       l_val_ = ptMap[l_val_];
@@ -8,17 +8,46 @@
 #ifndef SYSYC_MODULE_H
 #define SYSYC_MODULE_H
 
+#include <cstdint>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "Arena.h"
+#include "ConstantContext.h"
 #include "Function.h"
+#include "StringPool.h"
 #include "GlobalVariable.h"
 #include "Instruction.h"
 #include "Type.h"
+#include "TypeContext.h"
 #include "Value.h"
 
 class GlobalVariable;
+class Function;
+
+/**
+ * @brief 函数体的延迟读取接口
+ *
+ * @note 由延迟加载模块的读取器实现，归模块所有并随模块析构
+ */
+class Materializer {
+public:
+  virtual ~Materializer() = default;
+  /**
+   * @brief 读取函数体
+   *
+   * @param f 函数体尚未读取的函数
+   * @return true 读取成功
+   * @return false 函数体格式错误，函数保持为声明
+   */
+  virtual bool materialize(Function *f) = 0;
+};
 
 /**
  * @brief 模块类，中间结构的大类
@@ -26,16 +55,49 @@ class GlobalVariable;
  */
 class Module {
 private:
-  /// @brief 各基础类型指针
-  IntegerType *int1_ty_;
-  IntegerType *int32_ty_;
-  Type *label_ty_;
-  Type *void_ty_;
-  FloatType *float32_ty_;
+  /// @brief 内存池，模块内的类型、常量、全局量、函数、参数、基本块和指令均从中分配
+  Arena arena_;
+  /// @brief value名称的字符串池，字符存放在各线程的分配堆中
+  StringPool name_pool_;
+  /// @brief 模块持有的value，析构时统一调用析构函数
+  std::vector<Value *> owned_values_;
+  /// @brief 保护owned_values_，其他线程删除本线程创建的value时也会修改
+  std::mutex owned_values_mutex_;
+  /// @brief 模块持有的类型，析构时统一调用析构函数
+  std::vector<Type *> owned_types_;
 
-  /// @brief 指针映射图和数组映射图
-  std::map<Type *, PointerType *> pointer_map_;
-  std::map<std::pair<Type *, int>, ArrayType *> array_map_;
+  /**
+   * @brief 其他线程的分配堆
+   *
+   * @note 工作线程并发获取类型与常量时，未命中创建的对象从所在线程的堆分配
+   * 并登记，不与创建模块的线程争用内存池
+   */
+  struct ThreadHeap {
+    Arena arena_;
+    std::vector<Value *> owned_values_;
+    std::mutex owned_values_mutex_;
+    std::vector<Type *> owned_types_;
+  };
+  /// @brief 各工作线程的分配堆，线程首次在本模块分配时创建
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadHeap>>
+      thread_heaps_;
+  /// @brief 保护thread_heaps_，每个线程只在首次分配时加锁
+  std::mutex thread_heaps_mutex_;
+  /// @brief 创建模块的线程，直接使用arena_与登记表
+  std::thread::id owner_;
+  /// @brief 模块序号，供线程局部缓存识别模块
+  std::uint64_t serial_;
+  /**
+   * @brief 获取当前线程的分配堆
+   *
+   * @return ThreadHeap* 创建模块的线程为空，其余线程为各自的堆
+   */
+  ThreadHeap *get_thread_heap();
+
+  /// @brief 类型上下文，唯一化模块内的所有类型，需在内存池和类型登记表之后构造
+  TypeContext type_ctx_;
+  /// @brief 常量上下文，唯一化整数常量，需在类型上下文之后构造
+  ConstantContext const_ctx_;
 
   /// @brief 全局变量列表
   /// The Global Variables in the module
@@ -50,6 +112,8 @@ private:
   std::string module_name_;
   /// Original source file name for module, for test and debug
   std::string source_file_name_;
+  /// @brief 延迟读取函数体的读取器，非延迟加载的模块为空
+  std::unique_ptr<Materializer> materializer_;
 
 public:
   /**
@@ -61,9 +125,80 @@ public:
   /**
    * @brief Destroy the Module object
    *
+   * @note 析构模块持有的所有对象，内存随内存池一次释放
    */
-  ~Module();
+  virtual ~Module();
+
+  Module(const Module &) = delete;
+  Module &operator=(const Module &) = delete;
 
+  /**
+   * @brief 从模块内存池分配内存
+   *
+   * @param size 字节数
+   * @param align 对齐要求
+   * @param kind 对象种类，用于统计
+   * @return void* 内存起始地址
+   */
+  void *allocate(std::size_t size, std::size_t align, Arena::Kind kind);
+  /**
+   * @brief 登记value，模块析构时调用其析构函数
+   *
+   * @param v value指针
+   */
+  void own(Value *v);
+  /**
+   * @brief 登记类型，模块析构时调用其析构函数
+   *
+   * @param ty 类型指针
+   */
+  void own(Type *ty);
+  /**
+   * @brief 撤销value的登记，由value的析构函数调用
+   *
+   * @param v value指针
+   */
+  void disown(Value *v);
+  /**
+   * @brief 撤销类型的登记，用于构造失败的对象
+   *
+   * @param ty 类型指针
+   */
+  void disown(Type *ty);
+  /**
+   * @brief Get the arena object，获取模块内存池
+   *
+   * @return const Arena& 内存池引用，不含工作线程的分配堆
+   */
+  const Arena &get_arena() const { return arena_; }
+  /**
+   * @brief 打印各种类对象的内存占用
+   *
+   * @return std::string 含各工作线程分配堆的合计
+   */
+  std::string print_memory_usage();
+  /**
+   * @brief 将名称收录到模块的字符串池
+   *
+   * @param name 名称
+   * @return const std::string_view* 池中名称的指针
+   */
+  const std::string_view *intern_name(std::string_view name) {
+    return name_pool_.intern(name);
+  }
+
+  /**
+   * @brief Get the type context object，获取类型上下文
+   *
+   * @return TypeContext& 类型上下文引用
+   */
+  TypeContext &get_type_context() { return type_ctx_; }
+  /**
+   * @brief Get the constant context object，获取常量上下文
+   *
+   * @return ConstantContext& 常量上下文引用
+   */
+  ConstantContext &get_constant_context() { return const_ctx_; }
   /**
    * @brief Get the void type object，获取一个构建好的void类型指针
    *
@@ -155,11 +290,37 @@ public:
    * @brief Get the instr op name object，获取指令
    *
    * @param instr 指令id
-   * @return std::string ID的字符串表达
+   * @return const std::string& ID的字符串表达
+   * @note 只查找不插入，并行打印时可同时调用
    */
-  std::string get_instr_op_name(Instruction::OpID instr) {
-    return instr_id2string_[instr];
+  const std::string &get_instr_op_name(Instruction::OpID instr) const {
+    return instr_id2string_.find(instr)->second;
   }
+  /**
+   * @brief Set the materializer object，设置延迟读取函数体的读取器
+   *
+   * @param materializer 读取器，归模块所有
+   */
+  void set_materializer(std::unique_ptr<Materializer> materializer) {
+    materializer_ = std::move(materializer);
+  }
+  /**
+   * @brief 读取函数体，由Function::materialize调用
+   *
+   * @param f 函数体尚未读取的函数
+   * @return true 读取成功
+   * @return false 没有读取器或函数体格式错误
+   */
+  bool materialize(Function *f);
+  /**
+   * @brief 读取全部尚未读取的函数体
+   *
+   * @return true 全部读取成功
+   * @return false 有函数体格式错误
+   * @note 全局量与常量的use链只含已读取函数体中的使用，
+   * 依赖完整use链的变换或替换全局量前须先调用
+   */
+  bool materialize_all();
   /**
    * @brief Set the print name object，修正模块管理的函数下的名称
    *
@@ -171,6 +332,21 @@ public:
    * @return std::string
    */
   virtual std::string print();
+  /**
+   * @brief 将中间代码打印到输出流
+   *
+   * @param os 输出流，如写入文件的FdOutStream
+   * @note 按硬件线程数并行打印各函数
+   */
+  virtual void print(OutStream &os);
+  /**
+   * @brief 用给定线程数将中间代码打印到输出流
+   *
+   * @param os 输出流
+   * @param num_threads 打印函数的线程数，为0时取硬件线程数，为1时串行打印
+   * @note 输出与串行打印逐字节相同
+   */
+  void print(OutStream &os, unsigned num_threads);
 };
 
 #endif // SYSYC_MODULE_H
\ No newline at end of file
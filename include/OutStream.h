@@ -0,0 +1,181 @@
+/*!
+ *@file OutStream.h
+ *@brief 带缓冲的输出流接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_OUTSTREAM_H
+#define SYSYC_OUTSTREAM_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/*!
+ *@brief 带缓冲的输出流
+ *@note
+ *---------
+ *写入先进入定长缓冲区，缓冲区满或flush时整块交给子类写出；
+ *超过缓冲区大小的写入直接交给子类，不经缓冲区复制；
+ *整数经std::to_chars直接格式化到缓冲区，不构造临时字符串；
+ *子类须在析构函数中调用flush
+ */
+class OutStream {
+public:
+  static constexpr std::size_t DefaultBufferSize = 64 * 1024; // 默认缓冲区大小
+
+private:
+  char *buf_; // 缓冲区，无缓冲时为空
+  char *cur_; // 缓冲区中的空闲起点
+  char *end_; // 缓冲区的结束位置
+
+  /*!
+   *@brief 缓冲区放不下时的写入
+   *@param data 数据
+   *@param size 字节数
+   */
+  void write_slow(const char *data, std::size_t size);
+
+  /*!
+   *@brief 写入十进制整数
+   *@param val 整数值
+   *@return 输出流自身
+   */
+  template <typename T> OutStream &write_integer(T val);
+
+protected:
+  /*!
+   *@brief 输出流构造函数
+   *@param buf_size 缓冲区大小，为0时不缓冲
+   */
+  explicit OutStream(std::size_t buf_size);
+
+  /*!
+   *@brief 写出一块数据
+   *@param data 数据
+   *@param size 字节数
+   */
+  virtual void write_impl(const char *data, std::size_t size) = 0;
+
+public:
+  virtual ~OutStream();
+
+  OutStream(const OutStream &) = delete;
+  OutStream &operator=(const OutStream &) = delete;
+
+  /*!
+   *@brief 写入一段字节
+   *@param data 数据
+   *@param size 字节数
+   *@return 输出流自身
+   */
+  OutStream &write(const char *data, std::size_t size) {
+    if (size < static_cast<std::size_t>(end_ - cur_)) {
+      std::memcpy(cur_, data, size);
+      cur_ += size;
+    } else {
+      write_slow(data, size);
+    }
+    return *this;
+  }
+
+  /*!
+   *@brief 将缓冲区中的数据全部写出
+   */
+  void flush();
+
+  OutStream &operator<<(char c) {
+    if (cur_ != end_) {
+      *cur_++ = c;
+      return *this;
+    }
+    return write(&c, 1);
+  }
+  OutStream &operator<<(std::string_view str) {
+    return write(str.data(), str.size());
+  }
+  OutStream &operator<<(const char *str) {
+    return write(str, std::strlen(str));
+  }
+  OutStream &operator<<(const std::string &str) {
+    return write(str.data(), str.size());
+  }
+  OutStream &operator<<(int val);
+  OutStream &operator<<(unsigned val);
+  OutStream &operator<<(long long val);
+  OutStream &operator<<(unsigned long long val);
+
+  /*!
+   *@brief 写入定宽的大写十六进制数，不含0x前缀
+   *@param val 整数值
+   *@param width 位数，高位补0，超出的高位被截去
+   *@return 输出流自身
+   */
+  OutStream &write_hex(unsigned long long val, unsigned width);
+};
+
+/*!
+ *@brief 写入文件描述符的输出流
+ */
+class FdOutStream : public OutStream {
+private:
+  int fd_;             // 文件描述符
+  bool owns_fd_;       // 析构时是否关闭
+  bool error_ = false; // 是否发生过写入错误
+
+protected:
+  /*!
+   *@brief 写出一块数据，处理部分写入与信号中断
+   *@param data 数据
+   *@param size 字节数
+   */
+  void write_impl(const char *data, std::size_t size) override;
+
+public:
+  /*!
+   *@brief 写入已打开的文件描述符
+   *@param fd 文件描述符，如1为标准输出
+   *@param owns_fd 析构时是否关闭
+   */
+  explicit FdOutStream(int fd, bool owns_fd = false);
+
+  /*!
+   *@brief 创建或截断文件并写入
+   *@param path 文件路径
+   *@note 打开失败时has_error为真，写入被丢弃
+   */
+  explicit FdOutStream(const std::string &path);
+
+  ~FdOutStream() override;
+
+  /*!
+   *@brief 判断是否发生过打开或写入错误
+   *@return 判定结果
+   */
+  bool has_error() const { return error_; }
+};
+
+/*!
+ *@brief 追加到字符串的输出流
+ *@note 不经缓冲区，写入直接追加到目标字符串
+ */
+class StringOutStream : public OutStream {
+private:
+  std::string &str_; // 目标字符串
+
+protected:
+  void write_impl(const char *data, std::size_t size) override {
+    str_.append(data, size);
+  }
+
+public:
+  /*!
+   *@brief 字符串输出流构造函数
+   *@param str 目标字符串
+   */
+  explicit StringOutStream(std::string &str) : OutStream(0), str_(str) {}
+};
+
+#endif // SYSYC_OUTSTREAM_H
@@ -0,0 +1,91 @@
+/*!
+ *@file ShardedMap.h
+ *@brief 分片并发散列表接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_SHARDEDMAP_H
+#define SYSYC_SHARDEDMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/*!
+ *@brief 分片并发散列表，用于类型与常量的唯一化
+ *@note
+ *---------
+ *按键的散列值分为NumShards个分片，每个分片有独立的锁，
+ *不同分片上的查找与插入互不阻塞；
+ *未命中时在分片锁内创建对象，保证同一个键只创建一次；
+ *只增不删，返回的值在表的生命期内一直有效
+ */
+template <typename K, typename V, typename Hash, unsigned NumShards = 16>
+class ShardedMap {
+  static_assert((NumShards & (NumShards - 1)) == 0,
+                "shard count must be a power of 2");
+
+private:
+  /*! 一个分片，按缓存行对齐，避免相邻分片的锁互相干扰*/
+  struct alignas(64) Shard {
+    std::mutex mutex_;                   // 分片锁
+    std::unordered_map<K, V, Hash> map_; // 分片内的表
+  };
+
+  Shard shards_[NumShards]; // 各分片
+  Hash hash_;               // 键的散列
+
+  /*!
+   *@brief 按键选择分片
+   *@param key 键
+   *@return 分片引用
+   *@note 散列值再次混合后取高位，指针等低位规律明显的散列也能均匀分布
+   */
+  Shard &get_shard(const K &key) {
+    std::uint64_t h = static_cast<std::uint64_t>(hash_(key));
+    h = (h ^ (h >> 29)) * 0x9e3779b97f4a7c15ULL;
+    return shards_[(h >> 32) & (NumShards - 1)];
+  }
+
+public:
+  ShardedMap() = default;
+  ShardedMap(const ShardedMap &) = delete;
+  ShardedMap &operator=(const ShardedMap &) = delete;
+
+  /*!
+   *@brief 查找键，未命中时创建并登记
+   *@param key 查找用的键
+   *@param make 创建函数，返回(登记用的键, 值)，登记用的键须与key相等
+   *@return 键对应的值
+   *@note make在分片锁内调用，不得再访问同一张表
+   */
+  template <typename F> V get_or_create(const K &key, F make) {
+    Shard &shard = get_shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto it = shard.map_.find(key);
+    if (it != shard.map_.end()) {
+      return it->second;
+    }
+    std::pair<K, V> entry = make();
+    shard.map_.insert(entry);
+    return entry.second;
+  }
+
+  /*!
+   *@brief 获取登记的键个数
+   *@return 各分片的键个数之和
+   */
+  std::size_t size() {
+    std::size_t n = 0;
+    for (auto &shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex_);
+      n += shard.map_.size();
+    }
+    return n;
+  }
+};
+
+#endif // SYSYC_SHARDEDMAP_H
@@ -0,0 +1,118 @@
+/*!
+ *@file SmallVector.h
+ *@brief 小向量接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_SMALLVECTOR_H
+#define SYSYC_SMALLVECTOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+/*!
+ *@brief 小向量
+ *@note
+ *---------
+ *前N个元素存放在对象内部，不进行堆分配，超出后转到堆上按倍数扩充；
+ *仅用于可平凡复制的元素，如指针
+ */
+template <typename T, unsigned N> class SmallVector {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SmallVector only holds trivially copyable elements");
+
+private:
+  T *data_;           // 元素起始位置，指向inline_或堆
+  unsigned size_ = 0; // 元素个数
+  unsigned capacity_; // 当前容量
+  T inline_[N];       // 内部存储
+
+  bool is_small() const { return data_ == inline_; }
+
+  /*!
+   *@brief 扩充容量
+   *@param n 新容量
+   */
+  void grow(unsigned n) {
+    T *mem = static_cast<T *>(std::malloc(sizeof(T) * n));
+    if (mem == nullptr) {
+      throw std::bad_alloc();
+    }
+    std::memcpy(mem, data_, sizeof(T) * size_);
+    if (!is_small()) {
+      std::free(data_);
+    }
+    data_ = mem;
+    capacity_ = n;
+  }
+
+public:
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  SmallVector() : data_(inline_), capacity_(N) {}
+  SmallVector(const SmallVector &rhs) : SmallVector() { *this = rhs; }
+  ~SmallVector() {
+    if (!is_small()) {
+      std::free(data_);
+    }
+  }
+
+  SmallVector &operator=(const SmallVector &rhs) {
+    if (this != &rhs) {
+      size_ = 0;
+      if (rhs.size_ > capacity_) {
+        grow(rhs.size_);
+      }
+      std::memcpy(data_, rhs.data_, sizeof(T) * rhs.size_);
+      size_ = rhs.size_;
+    }
+    return *this;
+  }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  T &operator[](std::size_t i) { return data_[i]; }
+  const T &operator[](std::size_t i) const { return data_[i]; }
+  T &front() { return data_[0]; }
+  const T &front() const { return data_[0]; }
+  T &back() { return data_[size_ - 1]; }
+  const T &back() const { return data_[size_ - 1]; }
+
+  void push_back(const T &v) {
+    if (size_ == capacity_) {
+      grow(capacity_ * 2);
+    }
+    data_[size_++] = v;
+  }
+
+  void pop_back() {
+    assert(size_ > 0 && "pop_back on an empty vector");
+    size_--;
+  }
+
+  /*!
+   *@brief 删除元素，保持其余元素的顺序
+   *@param pos 待删除元素的位置
+   *@return 指向下一个元素的迭代器
+   */
+  iterator erase(iterator pos) {
+    std::memmove(pos, pos + 1, sizeof(T) * (end() - pos - 1));
+    size_--;
+    return pos;
+  }
+
+  void clear() { size_ = 0; }
+};
+
+#endif // SYSYC_SMALLVECTOR_H
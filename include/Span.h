@@ -0,0 +1,71 @@
+/*!
+ *@file Span.h
+ *@brief 连续元素视图接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_SPAN_H
+#define SYSYC_SPAN_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/*!
+ *@brief 连续元素的只读视图
+ *@note
+ *---------
+ *只保存起始指针与元素个数，不拥有存储，复制代价为两个字；
+ *所指存储须比视图活得久，如模块内存池中的数据
+ */
+template <typename T> class Span {
+private:
+  const T *data_ = nullptr; // 元素起始位置
+  std::size_t size_ = 0;    // 元素个数
+
+public:
+  using iterator = const T *;
+  using const_iterator = const T *;
+
+  Span() = default;
+  Span(const T *data, std::size_t size) : data_(data), size_(size) {}
+  Span(const std::vector<T> &vec) : data_(vec.data()), size_(vec.size()) {}
+
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+  const T *data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const T &operator[](std::size_t i) const {
+    assert(i < size_ && "span index out of range");
+    return data_[i];
+  }
+
+  /*!
+   *@brief 复制为向量
+   *@return 元素的副本
+   */
+  std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+  /*!
+   *@brief 逐元素比较
+   *@param rhs 另一个视图
+   *@return 元素个数与各元素均相同
+   */
+  bool operator==(const Span &rhs) const {
+    if (size_ != rhs.size_) {
+      return false;
+    }
+    for (std::size_t i = 0; i < size_; i++) {
+      if (!(data_[i] == rhs.data_[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool operator!=(const Span &rhs) const { return !(*this == rhs); }
+};
+
+#endif // SYSYC_SPAN_H
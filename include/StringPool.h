@@ -0,0 +1,58 @@
+/*!
+ *@file StringPool.h
+ *@brief 字符串池接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_STRINGPOOL_H
+#define SYSYC_STRINGPOOL_H
+
+#include "ShardedMap.h"
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+class Module;
+
+/*!
+ *@brief 字符串池
+ *@note
+ *---------
+ *相同内容的字符串只保存一份，字符与视图均存放在模块内存池中，
+ *返回的指针在字符串池存续期间保持有效；
+ *按分片加锁，并行打印各函数时可同时收录名称
+ */
+class StringPool {
+private:
+  Module *m_; // 字符存放的模块
+  ShardedMap<std::string_view, const std::string_view *,
+             std::hash<std::string_view>>
+      strings_; // 已收录的字符串，值为池中的视图
+
+public:
+  /*!
+   *@brief 字符串池构造函数
+   *@param m 字符存放的模块，从其所在线程的分配堆分配
+   */
+  explicit StringPool(Module *m) : m_(m) {}
+
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+
+  /*!
+   *@brief 收录字符串
+   *@param str 待收录的字符串
+   *@return 池中字符串的指针，内容相同的字符串返回同一指针
+   */
+  const std::string_view *intern(std::string_view str);
+
+  /*!
+   *@brief 获取已收录的字符串个数
+   *@return 个数
+   */
+  std::size_t size() { return strings_.size(); }
+};
+
+#endif // SYSYC_STRINGPOOL_H
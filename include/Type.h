@@ -8,7 +8,10 @@
 #ifndef SYSYC_TYPE_H
 #define SYSYC_TYPE_H
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <string_view>
 #include <vector>
 
 class Module;
@@ -40,11 +43,49 @@ public:
     FloatTyID     // float
   };
 
+  /// @brief 基础类型的大小（字节）
+  static constexpr unsigned Int1Size = 1;
+  static constexpr unsigned Int32Size = 4;
+  static constexpr unsigned FloatSize = 4;
+  static constexpr unsigned PointerSize = 4;
+
+  /**
+   * @brief 获取基础类型的大小，编译期可求值
+   *
+   * @param tid 类型ID
+   * @return unsigned 大小（字节），数组、函数、void与label为0
+   */
+  static constexpr unsigned get_primitive_size(TypeID tid) {
+    switch (tid) {
+    case IntegerTy1ID:
+      return Int1Size;
+    case IntegerTy32ID:
+      return Int32Size;
+    case FloatTyID:
+      return FloatSize;
+    case PointerTyID:
+      return PointerSize;
+    default:
+      return 0;
+    }
+  }
+
 private:
   TypeID tid_;
   Module *m_;
+  /// @brief 指向本类型的指针类型，首次获取时由类型上下文创建，可并发读写
+  std::atomic<PointerType *> pointer_to_{nullptr};
   virtual void _t(){};
 
+  friend class TypeContext;
+
+protected:
+  /// @brief 布局信息，创建类型时计算一次
+  unsigned size_;  // 大小（字节）
+  unsigned align_; // 对齐（字节）
+  /// @brief 类型文本，字符存放在模块内存池中
+  std::string_view spelling_;
+
 public:
   /**
    * @brief Construct a new Type object
@@ -56,9 +97,31 @@ public:
   /**
    * @brief Destroy the Type object
    *
+   * @note 由所属模块统一调用，不可对类型使用delete
    */
   virtual ~Type() = default;
 
+  /**
+   * @brief 从模块内存池分配类型对象
+   *
+   * @param size 对象大小
+   * @param m 所属模块
+   * @return void* 对象起始地址
+   */
+  void *operator new(std::size_t size, Module *m);
+  /**
+   * @brief 内存归模块内存池所有，不单独释放
+   *
+   */
+  void operator delete(void *) {}
+  /**
+   * @brief 构造失败时撤销登记
+   *
+   * @param ptr 对象指针
+   * @param m 所属模块
+   */
+  void operator delete(void *ptr, Module *m);
+
   /**
    * @brief Get the type id object，获取类型ID
    *
@@ -145,6 +208,7 @@ public:
    *
    * @return true 是
    * @return false 不是
+   * @note 类型由类型上下文唯一化，结构相同即为同一对象，O(1)
    */
   static bool is_eq_type(Type *ty1, Type *ty2);
 
@@ -238,9 +302,24 @@ public:
    *
    * @param extended 范围是否延申，即在判定数组指针时，是否计算指向的数组大小
    * @return int 大小
+   * @note 读取创建时计算好的布局，O(1)
    */
   int get_size(bool extended = true);
 
+  /**
+   * @brief Get the alloc size object，获取类型本身的大小
+   *
+   * @return unsigned 大小（字节），指针类型不展开指向的数组
+   */
+  unsigned get_alloc_size() const { return size_; }
+
+  /**
+   * @brief Get the alignment object，获取类型的对齐
+   *
+   * @return unsigned 对齐（字节），数组与元素一致
+   */
+  unsigned get_alignment() const { return align_; }
+
   /**
    * @brief Get the module object，获取所属模块
    *
@@ -251,9 +330,17 @@ public:
   /**
    * @brief 打印类型
    *
-   * @return std::string，字符串
+   * @return std::string_view 创建时缓存的类型文本，随模块内存池存续
    */
-  std::string print();
+  std::string_view print() const { return spelling_; }
+
+protected:
+  /**
+   * @brief 生成并缓存类型文本
+   *
+   * @note 组成类型的文本已缓存，只需一层拼接；由各构造函数在成员就绪后调用
+   */
+  void cache_spelling();
 };
 
 /**
@@ -296,7 +383,7 @@ public:
    *
    * @param num_bits 位数
    * @param m 所属模块
-   * @return IntegerType*
+   * @return IntegerType* 模块内唯一的整数类型
    */
   static IntegerType *get(unsigned num_bits, Module *m);
 
@@ -349,11 +436,11 @@ public:
   static bool is_valid_argument_type(Type *ty);
 
   /**
-   * @brief 创建一个函数类型指针
+   * @brief 获取一个函数类型指针
    *
    * @param result 返回参数类型指针
    * @param params 参数类型指针数组
-   * @return FunctionType* 函数类型指针
+   * @return FunctionType* 模块内唯一的函数类型指针
    */
   static FunctionType *get(Type *result, std::vector<Type *> params);
 
@@ -383,6 +470,12 @@ public:
    * @return std::vector<Type *>::iterator 迭代器，最后一个参数指针
    */
   std::vector<Type *>::iterator param_end() { return args_.end(); }
+  /**
+   * @brief Get the params object，获取参数类型列表
+   *
+   * @return const std::vector<Type *>& 参数类型列表
+   */
+  const std::vector<Type *> &get_params() const { return args_; }
   /**
    * @brief Get the return type object，获取返回类型的指针
    *
@@ -399,6 +492,8 @@ class ArrayType : public Type {
 private:
   Type *contained_;       // The element type of the array.
   unsigned num_elements_; // Number of elements in the array.
+  Type *scalar_;          // 多维数组最内层的元素类型
+  unsigned num_flat_;     // 展平后的标量元素个数
 protected:
 public:
   /**
@@ -439,6 +534,25 @@ public:
    * @return unsigned 元素个数
    */
   unsigned get_num_of_elements() const { return num_elements_; }
+  /**
+   * @brief Get the stride object，获取本维相邻元素的间距
+   *
+   * @return unsigned 间距（字节），即元素类型的大小
+   * @note 多维数组第k维的间距为第k层数组类型的间距
+   */
+  unsigned get_stride() const { return contained_->get_alloc_size(); }
+  /**
+   * @brief Get the scalar type object，获取多维数组最内层的元素类型
+   *
+   * @return Type* 标量类型
+   */
+  Type *get_scalar_type() const { return scalar_; }
+  /**
+   * @brief Get the num of flat elements object，获取展平后的元素个数
+   *
+   * @return unsigned 各维元素个数之积
+   */
+  unsigned get_num_of_flat_elements() const { return num_flat_; }
 };
 
 /**
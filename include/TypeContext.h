@@ -0,0 +1,160 @@
+/*!
+ *@file TypeContext.h
+ *@brief 类型上下文接口头文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#ifndef SYSYC_TYPECONTEXT_H
+#define SYSYC_TYPECONTEXT_H
+
+#include "ShardedMap.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+class Module;
+class Type;
+class IntegerType;
+class FloatType;
+class FunctionType;
+class ArrayType;
+class PointerType;
+
+/**
+ * @brief 类型上下文
+ *
+ * @note 模块内每种结构的类型只创建一次，结构相同的类型即为同一对象，
+ * 类型相等判断退化为指针比较
+ * @note 数组与函数类型按结构散列唯一化；指针类型缓存在被指向的类型上
+ * @note 各获取函数可由多个线程并发调用：数组与函数类型表分片加锁，
+ * 指针类型以原子比较交换发布，基础类型在构造时创建后只读
+ */
+class TypeContext {
+private:
+  /// @brief 数组类型的结构：元素类型与元素个数
+  using ArrayKey = std::pair<Type *, unsigned>;
+  /**
+   * @brief 数组类型结构的散列
+   *
+   */
+  struct ArrayKeyHash {
+    std::size_t operator()(const ArrayKey &key) const;
+  };
+
+  /**
+   * @brief 函数类型的结构：返回类型与参数类型列表
+   *
+   * @note 参数列表只保存指针，登记后的键指向函数类型自身的参数列表
+   */
+  struct FunctionKey {
+    Type *result_;
+    const std::vector<Type *> *params_;
+    bool operator==(const FunctionKey &rhs) const {
+      return result_ == rhs.result_ && *params_ == *rhs.params_;
+    }
+  };
+  /**
+   * @brief 函数类型结构的散列
+   *
+   */
+  struct FunctionKeyHash {
+    std::size_t operator()(const FunctionKey &key) const;
+  };
+
+  /// @brief 所属模块，类型从其内存池分配
+  Module *m_;
+  /// @brief 各基础类型指针
+  Type *void_ty_;
+  Type *label_ty_;
+  IntegerType *int1_ty_;
+  IntegerType *int32_ty_;
+  FloatType *float32_ty_;
+  /// @brief 已创建的数组类型和函数类型
+  ShardedMap<ArrayKey, ArrayType *, ArrayKeyHash> array_types_;
+  ShardedMap<FunctionKey, FunctionType *, FunctionKeyHash> function_types_;
+
+public:
+  /**
+   * @brief Construct a new Type Context object，创建各基础类型
+   *
+   * @param m 所属模块，其内存池需已构造
+   */
+  explicit TypeContext(Module *m);
+
+  TypeContext(const TypeContext &) = delete;
+  TypeContext &operator=(const TypeContext &) = delete;
+
+  /**
+   * @brief Get the void type object
+   *
+   * @return Type* void类型指针
+   */
+  Type *get_void_type() const { return void_ty_; }
+  /**
+   * @brief Get the label type object
+   *
+   * @return Type* label类型指针
+   */
+  Type *get_label_type() const { return label_ty_; }
+  /**
+   * @brief Get the int1 type object
+   *
+   * @return IntegerType* 1位整数类型指针
+   */
+  IntegerType *get_int1_type() const { return int1_ty_; }
+  /**
+   * @brief Get the int32 type object
+   *
+   * @return IntegerType* 32位整数类型指针
+   */
+  IntegerType *get_int32_type() const { return int32_ty_; }
+  /**
+   * @brief Get the float type object
+   *
+   * @return FloatType* 浮点类型指针
+   */
+  FloatType *get_float_type() const { return float32_ty_; }
+  /**
+   * @brief Get the int type object，按位数获取整数类型
+   *
+   * @param num_bits 位数：32/1
+   * @return IntegerType* 整数类型指针
+   */
+  IntegerType *get_int_type(unsigned num_bits) const;
+  /**
+   * @brief Get the pointer type object，获取指向contained的指针类型
+   *
+   * @param contained 指针指向数据的类型
+   * @return PointerType* 指针类型指针
+   * @note 首次创建后缓存在contained上，之后O(1)返回，无需加锁
+   */
+  PointerType *get_pointer_type(Type *contained);
+  /**
+   * @brief Get the array type object，获取唯一的数组类型
+   *
+   * @param contained 数组元素类型
+   * @param num_elements 数组元素个数
+   * @return ArrayType* 数组类型指针
+   */
+  ArrayType *get_array_type(Type *contained, unsigned num_elements);
+  /**
+   * @brief Get the function type object，获取唯一的函数类型
+   *
+   * @param result 返回类型
+   * @param params 参数类型列表
+   * @return FunctionType* 函数类型指针
+   */
+  FunctionType *get_function_type(Type *result, std::vector<Type *> params);
+  /**
+   * @brief 获取已唯一化的数组与函数类型个数
+   *
+   * @return std::size_t 个数
+   */
+  std::size_t get_num_uniqued_types() {
+    return array_types_.size() + function_types_.size();
+  }
+};
+
+#endif // SYSYC_TYPECONTEXT_H
@@ -9,35 +9,204 @@
 #define SYSYC_USER_H
 
 #include "Value.h"
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
-/*! user类，中间IR的基础*/
+/*! operand迭代器，按顺序访问User的operand value*/
+class OperandIterator {
+private:
+  Use *cur_;
+
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = Value *;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Value **;
+  using reference = Value *;
+
+  explicit OperandIterator(Use *u = nullptr) : cur_(u) {}
+  Value *operator*() const { return cur_->get(); }
+  Value *operator[](difference_type n) const { return cur_[n].get(); }
+  OperandIterator &operator++() {
+    ++cur_;
+    return *this;
+  }
+  OperandIterator operator++(int) { return OperandIterator(cur_++); }
+  OperandIterator &operator--() {
+    --cur_;
+    return *this;
+  }
+  OperandIterator operator--(int) { return OperandIterator(cur_--); }
+  OperandIterator &operator+=(difference_type n) {
+    cur_ += n;
+    return *this;
+  }
+  OperandIterator &operator-=(difference_type n) {
+    cur_ -= n;
+    return *this;
+  }
+  OperandIterator operator+(difference_type n) const {
+    return OperandIterator(cur_ + n);
+  }
+  OperandIterator operator-(difference_type n) const {
+    return OperandIterator(cur_ - n);
+  }
+  difference_type operator-(const OperandIterator &rhs) const {
+    return cur_ - rhs.cur_;
+  }
+  bool operator==(const OperandIterator &rhs) const { return cur_ == rhs.cur_; }
+  bool operator!=(const OperandIterator &rhs) const { return cur_ != rhs.cur_; }
+  bool operator<(const OperandIterator &rhs) const { return cur_ < rhs.cur_; }
+};
+
+/*! operand区间，不持有存储*/
+class OperandRange {
+private:
+  Use *begin_;
+  Use *end_;
+
+public:
+  OperandRange(Use *b, Use *e) : begin_(b), end_(e) {}
+  OperandIterator begin() const { return OperandIterator(begin_); }
+  OperandIterator end() const { return OperandIterator(end_); }
+  std::size_t size() const { return end_ - begin_; }
+  bool empty() const { return begin_ == end_; }
+  Value *operator[](std::size_t i) const { return begin_[i].get(); }
+};
+
+/*! user类，中间IR的基础
+ *@note
+ *---------
+ *operand槽有两种存放方式：
+ *&emsp; 定长：operand槽与对象一次分配，紧挨在对象之前，无额外分配和指针跳转
+ *&emsp; 可增长(hung-off)：对象之前只保留一个指针，指向独立分配的operand槽，
+ *&emsp; 仅PhiInst和CallInst使用
+ */
 class User : public Value {
 private:
+  unsigned num_ops_ : 31;      // value值的个数
+  unsigned hung_off_ops_ : 1;  // operand槽是否为独立分配
+  unsigned reserved_ops_;      // 独立分配operand槽的容量
+
+  /*!
+   *@brief 获取独立分配operand槽的指针所在位置
+   *@return 对象之前的指针槽
+   */
+  Use **hung_off_slot() const {
+    return reinterpret_cast<Use **>(const_cast<User *>(this)) - 1;
+  }
+
+  /*!
+   *@brief 扩充独立分配operand槽的容量
+   *@param n 新容量
+   *@note 已挂链的use节点原位迁移，不改变各use链中的顺序
+   */
+  void grow_operands(unsigned n);
+
 protected:
-  std::vector<Value *> operands_; // operands of this value
-  unsigned num_ops_;              // value值的个数
+  /*!
+   *@brief 获取operand槽的起始位置
+   *@return 第一个use节点指针
+   */
+  Use *op_begin() const {
+    return hung_off_ops_ ? *hung_off_slot()
+                         : reinterpret_cast<Use *>(const_cast<User *>(this)) -
+                               num_ops_;
+  }
+
+  /*!
+   *@brief 获取operand槽的结束位置
+   *@return 最后一个use节点之后的指针
+   */
+  Use *op_end() const { return op_begin() + num_ops_; }
+
+  /*!
+   *@brief 获取对象之前operand槽（或其指针）占用的字节数
+   *@return 字节数
+   */
+  std::size_t get_operand_prefix_size() const {
+    return hung_off_ops_ ? sizeof(Use *) : sizeof(Use) * num_ops_;
+  }
+
+  /*!
+   *@brief 获取独立分配的operand槽
+   *@return operand槽起始位置，定长operand时为nullptr
+   */
+  Use *get_hung_off_operands() const {
+    return hung_off_ops_ ? *hung_off_slot() : nullptr;
+  }
+
+  /*!
+   *@brief 获取独立分配operand槽的容量
+   *@return 容量
+   */
+  unsigned get_reserved_operands() const { return reserved_ops_; }
+
+  /*!
+   *@brief 从模块内存池中分配定长operand的User
+   *@param size 对象大小
+   *@param m 所属模块
+   *@param kind 对象种类
+   *@param num_ops operand个数
+   *@return 对象起始地址，operand槽位于其前
+   */
+  static void *allocate_with_operands(std::size_t size, Module *m,
+                                      Arena::Kind kind, unsigned num_ops) {
+    return Value::allocate(size, m, kind, sizeof(Use) * num_ops);
+  }
+
+  /*!
+   *@brief 从模块内存池中分配operand可增长的User
+   *@param size 对象大小
+   *@param m 所属模块
+   *@param kind 对象种类
+   *@return 对象起始地址，其前预留一个指针
+   */
+  static void *allocate_hung_off(std::size_t size, Module *m,
+                                 Arena::Kind kind) {
+    return Value::allocate(size, m, kind, sizeof(Use *));
+  }
 
 public:
+  /*! 分配标记：operand槽独立分配、可增长*/
+  struct HungOffTag {};
+  static constexpr HungOffTag hung_off{};
+
   /*!
    *@brief User的构造函数
    *@param ty 类型
+   *@param vid 子类型ID
    *@param name User名称
    *@param num_ops value的位置
+   *@param hung_off operand槽是否为独立分配，需与分配方式一致
    *@return 当前对象本身
    */
-  User(Type *ty, const std::string &name = "", unsigned num_ops = 0);
+  User(Type *ty, unsigned vid, std::string_view name = "",
+       unsigned num_ops = 0, bool hung_off = false);
+
+  /*!
+   *@brief User的析构函数
+   *@note 摘除所有operand的use节点，operand槽的内存归模块内存池所有
+   */
+  ~User();
+
+  User(const User &) = delete;
+  User &operator=(const User &) = delete;
 
   /*!
-   *@brief Value的析构函数
+   *@brief 获得包含value指针的区间
+   *@return 返回User维护的Value区间
    */
-  ~User() = default;
+  OperandRange get_operands() const {
+    return OperandRange(op_begin(), op_end());
+  }
 
   /*!
-   *@brief 获得包含value指针的数组
-   *@return 返回User维护的Value数组
+   *@brief 获得第i个operand槽的use节点
+   *@return use引用
    */
-  std::vector<Value *> &get_operands();
+  Use &get_operand_use(unsigned i) { return op_begin()[i]; }
 
   /*!
    *@brief 获得数组中的第i个value数值指针
@@ -58,6 +227,7 @@ public:
    *@param v value数值指针
    *@note
    *--------
+   *&emsp; 仅适用于独立分配operand槽的User
    *&emsp; value数组尾插入一个value
    *&emsp; 为value添加一个use关系
    *&emsp; 计数加一
@@ -71,22 +241,30 @@ public:
    *-------
    *判断
    */
-  unsigned get_num_operand() const;
+  unsigned get_num_operand() const { return num_ops_; }
 
   /*!
-   *@brief 添加新的value数值指针
-   *@param v value数值指针
+   *@brief 将所有operand的use节点从各自的use链上摘除
    *@note
    *--------
-   *
+   *operand数值保持不变
    */
   void remove_use_of_ops();
 
   /*!
-   *@brief 添加新的value数值指针
+   *@brief 判断value是否为User
+   *@param v value指针
+   *@return 判定结果
+   */
+  static bool classof(const Value *v) {
+    return v->get_value_id() >= Value::GlobalVariableVal;
+  }
+
+  /*!
+   *@brief 删除指定范围的operands
    *@param index1 索引1
    *@param index2 索引2
-   *@note
+   *@note 仅适用于独立分配operand槽的User
    */
   void remove_operands(int index1, int index2);
 };
@@ -8,18 +8,79 @@
 #ifndef SYSYC_VALUE_H
 #define SYSYC_VALUE_H
 
+#include "Arena.h"
+#include "OutStream.h"
+
+#include <cstddef>
 #include <iostream>
-#include <list>
+#include <iterator>
 #include <string>
+#include <string_view>
 
+class Module;
 class Type;
 class Value;
 
-/*! use结构体，作为中间IR的基础*/
+/*! use结构体，作为中间IR的基础
+ *@note
+ *---------
+ *侵入式节点：use存放在User的operand槽中，同时挂入被使用value的use链，
+ *链入、摘除与替换均为O(1)，不再额外分配链表节点
+ */
 struct Use {
-  Value *val_;      // 使用value的value
-  unsigned arg_no_; // the no. of operand, e.g., func(a, b), a is 0, b is 1
+  Value *val_;            // 使用value的value
+  unsigned arg_no_;       // the no. of operand, e.g., func(a, b), a is 0, b is 1
+  Value *used_ = nullptr; // 被使用的value
+  Use *next_ = nullptr;   // use链中的后继节点
+  Use **prev_ = nullptr;  // 指向use链中前驱节点的next_（或链头）
   Use(Value *val, unsigned no) : val_(val), arg_no_(no) {} // 构造函数
+  Use(const Use &) = delete;
+  Use &operator=(const Use &) = delete;
+
+  /*!
+   *@brief 获取被使用的value
+   *@return value指针
+   */
+  Value *get() const { return used_; }
+
+  /*!
+   *@brief 获取使用者
+   *@return 使用该value的value
+   */
+  Value *get_user() const { return val_; }
+
+  /*!
+   *@brief 判断该use是否挂在某个value的use链上
+   *@return 判定结果
+   */
+  bool is_linked() const { return prev_ != nullptr; }
+
+  /*!
+   *@brief 修改被使用的value
+   *@param v 新的被使用value，可以为空
+   *@note
+   *---------
+   *先从旧value的use链上摘除，再挂入新value的use链
+   */
+  void set(Value *v);
+
+  /*!
+   *@brief 从所在的use链上摘除，保留被使用的value
+   */
+  inline void unlink();
+
+  /*!
+   *@brief 判断被使用的value是否为基本块
+   *@return 判定结果
+   */
+  inline bool uses_block() const;
+
+  /*!
+   *@brief 同步跳转指令目标的前置基本块
+   *@param linked 挂链为true，摘链为false
+   *@note 使用者为跳转指令时增删目标基本块的前置基本块
+   */
+  void update_cfg_edge(bool linked);
 
   /*!
    *@brief 判定两个use是否相等
@@ -32,26 +93,148 @@ struct Use {
   }
 };
 
+/*! use链，由use节点自身串联的双向链表*/
+class UseList {
+private:
+  Use *head_ = nullptr; // 链头
+
+public:
+  /*! use链迭代器*/
+  class iterator {
+  private:
+    Use *cur_;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Use;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Use *;
+    using reference = Use &;
+
+    explicit iterator(Use *u = nullptr) : cur_(u) {}
+    Use &operator*() const { return *cur_; }
+    Use *operator->() const { return cur_; }
+    iterator &operator++() {
+      cur_ = cur_->next_;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator tmp = *this;
+      cur_ = cur_->next_;
+      return tmp;
+    }
+    bool operator==(const iterator &rhs) const { return cur_ == rhs.cur_; }
+    bool operator!=(const iterator &rhs) const { return cur_ != rhs.cur_; }
+  };
+
+  iterator begin() const { return iterator(head_); }
+  iterator end() const { return iterator(nullptr); }
+
+  /*!
+   *@brief 判断use链是否为空
+   *@return 判定结果
+   */
+  bool empty() const { return head_ == nullptr; }
+
+  /*!
+   *@brief 获取use链的第一个节点
+   *@return use引用
+   */
+  Use &front() const { return *head_; }
+
+  /*!
+   *@brief use链长度
+   *@return 节点个数
+   *@note 需要遍历整条链
+   */
+  std::size_t size() const {
+    std::size_t n = 0;
+    for (Use *u = head_; u; u = u->next_)
+      ++n;
+    return n;
+  }
+
+  /*!
+   *@brief 在链头挂入一个use节点
+   *@param use 待挂入的use
+   */
+  void push_front(Use *use) {
+    use->next_ = head_;
+    if (head_)
+      head_->prev_ = &use->next_;
+    use->prev_ = &head_;
+    head_ = use;
+  }
+};
+
 /*! value类，作为中间IR的基础*/
 class Value {
+public:
+  /*!
+   *@brief value子类型ID
+   *@note
+   *---------
+   *指令的ID为InstructionVal + OpID，isa/cast/dyn_cast只比较该整数
+   */
+  enum ValueID {
+    ArgumentVal,
+    BasicBlockVal,
+    FunctionVal,
+    GlobalVariableVal,
+    ConstantIntVal,
+    ConstantFPVal,
+    ConstantArrayVal,
+    ConstantDataArrayVal,
+    ConstantSparseArrayVal,
+    ConstantZeroVal,
+    InstructionVal,
+
+    ConstantFirstVal = ConstantIntVal,
+    ConstantLastVal = ConstantZeroVal,
+  };
+
 private:
+  const unsigned value_id_; // 子类型ID
+  unsigned owned_slot_;     // 在所属模块登记表中的位置
+
+  friend class Module;
+
 protected:
   Type *type_;
-  std::list<Use> use_list_; // 使用value的value list
-  std::string name_;        // value名称
+  UseList use_list_;        // 使用value的value list
+  const std::string_view *name_ = nullptr; // 模块字符串池中的名称，匿名为空
+
+  /*!
+   *@brief 从模块内存池中分配value
+   *@param size 对象大小
+   *@param m 所属模块
+   *@param kind 对象种类，用于统计
+   *@param prefix 对象之前预留的字节数，存放operand槽
+   *@return 对象起始地址
+   */
+  static void *allocate(std::size_t size, Module *m, Arena::Kind kind,
+                        std::size_t prefix = 0);
 
 public:
   /*!
    *@brief Value的构造函数
    *@param ty 类型
+   *@param vid 子类型ID
    *@param name value名称
    *@return 当前对象本身
+   *@note 登记到类型所属的模块中，由模块析构时统一析构
    */
-  explicit Value(Type *ty, const std::string &name = "");
+  Value(Type *ty, unsigned vid, std::string_view name = "");
   /*!
    *@brief Value的析构函数
+   *@note 从所属模块中撤销登记；由模块或erase接口调用，不可对value使用delete
    */
-  ~Value() = default;
+  virtual ~Value();
+
+  /*!
+   *@brief 内存归模块内存池所有，不单独释放
+   */
+  void operator delete(void *) {}
 
   /*!
    *@brief 获取value的类型
@@ -59,18 +242,23 @@ public:
    */
   Type *get_type() const { return type_; }
 
+  /*!
+   *@brief 获取value的子类型ID
+   *@return ValueID，指令为InstructionVal + OpID
+   */
+  unsigned get_value_id() const { return value_id_; }
+
   /*!
    *@brief 获取使用该value的use list
    *@return 返回use-list的引用
    */
-  std::list<Use> &get_use_list() { return use_list_; }
+  UseList &get_use_list() { return use_list_; }
 
   /*!
    *@brief 添加use
-   *@param val 使用该value的value
-   *@param arg_no 在指令中的顺序
+   *@param use 使用者operand槽中的use节点
    */
-  void add_use(Value *val, unsigned arg_no = 0);
+  void add_use(Use *use) { use_list_.push_front(use); }
 
   /*!
    *@brief 对于value设置名称
@@ -80,19 +268,21 @@ public:
    *---------
    *名字为空即设置新名字，设置后不再进行修改
    */
-  bool set_name(std::string name) {
-    if (name_ == "") {
-      name_ = name;
-      return true;
-    }
-    return false;
-  }
+  bool set_name(std::string_view name);
+
+  /*!
+   *@brief 判断value是否有名称
+   *@return 判定结果
+   */
+  bool has_name() const { return name_ != nullptr; }
 
   /*!
    *@brief 获取value的名称
-   *@return value字符串常量
+   *@return 名称视图，指向模块字符串池，匿名value为空视图
    */
-  std::string get_name() const;
+  std::string_view get_name() const {
+    return name_ ? *name_ : std::string_view();
+  }
 
   /*!
    *@brief 替换所有对于旧value的引用，改为新的
@@ -104,22 +294,61 @@ public:
   void replace_all_use_with(Value *new_val);
 
   /*!
-   *@brief 替换所有对于旧value的引用，改为新的
-   *@param val value型指针
+   *@brief 删除val对于本value的所有使用
+   *@param val value型指针，使用本value的User
    *@note
    *----------
-   *支持对于指令级别value的替换
+   *只遍历val自身的operand槽，代价与use链长度无关
    */
   void remove_use(Value *val);
 
   /*!
    *@brief value的打印
-   *@return 默认为空
+   *@return 字符串
+   *@note 经字符串输出流调用print_ir
+   */
+  std::string print();
+
+  /*!
+   *@brief 将value打印到输出流
+   *@param os 输出流
+   */
+  void print(OutStream &os) { print_ir(os); }
+
+  /*!
+   *@brief 打印到输出流的实现
+   *@param os 输出流
    *@note
    *--------
-   *后期根据不同类型的value进行修改，作为一个虚函数出现
+   *默认不输出，各子类按自身格式重写；外部统一经print调用
    */
-  virtual std::string print() { return ""; }
+  virtual void print_ir(OutStream &) {}
 };
 
+/*!
+ *@brief 判断被使用的value是否为基本块
+ *@return 判定结果
+ */
+inline bool Use::uses_block() const {
+  return used_ != nullptr && used_->get_value_id() == Value::BasicBlockVal;
+}
+
+/*!
+ *@brief 从所在的use链上摘除，保留被使用的value
+ *@note 被使用的是基本块时同步CFG
+ */
+inline void Use::unlink() {
+  if (prev_ == nullptr)
+    return;
+  *prev_ = next_;
+  if (next_)
+    next_->prev_ = prev_;
+  next_ = nullptr;
+  prev_ = nullptr;
+  if (uses_block())
+    update_cfg_edge(false);
+}
+
+#include "Casting.h"
+
 #endif // SYSYC_VALUE_H
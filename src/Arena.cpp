@@ -0,0 +1,155 @@
+/*!
+ *@file Arena.cpp
+ *@brief 模块内存池接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#include "Arena.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/*!
+ *@brief 内存池构造函数
+ */
+Arena::Arena() : next_slab_size_(InitialSlabSize) {
+  for (int i = 0; i < NumKinds; i++) {
+    bytes_used_[i] = 0;
+  }
+}
+
+/*!
+ *@brief 内存池析构函数，归还所有slab
+ */
+Arena::~Arena() {
+  for (char *slab : slabs_) {
+    std::free(slab);
+  }
+}
+
+/*!
+ *@brief 申请一个新的slab
+ *@param size slab字节数
+ *@return slab起始地址
+ */
+char *Arena::new_slab(std::size_t size) {
+  char *slab = static_cast<char *>(std::malloc(size));
+  if (slab == nullptr) {
+    throw std::bad_alloc();
+  }
+  slabs_.push_back(slab);
+  bytes_reserved_ += size;
+  return slab;
+}
+
+/*!
+ *@brief 分配一块内存
+ *@param size 字节数
+ *@param align 对齐要求，需为2的幂
+ *@param kind 对象种类
+ *@return 内存起始地址
+ *@note
+ *---------
+ *slab大小逐次翻倍直至上限；超过slab大小一半的请求单独申请一块，
+ *不影响当前slab的剩余空间
+ */
+void *Arena::allocate(std::size_t size, std::size_t align, Kind kind) {
+  assert((align & (align - 1)) == 0 && "alignment must be a power of 2");
+  bytes_used_[kind] += size;
+  std::uintptr_t mask = ~static_cast<std::uintptr_t>(align - 1);
+  std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cur_) + align - 1) & mask;
+  if (cur_ != nullptr && p + size <= reinterpret_cast<std::uintptr_t>(end_)) {
+    cur_ = reinterpret_cast<char *>(p + size);
+    return reinterpret_cast<void *>(p);
+  }
+  if (size + align > next_slab_size_ / 2) {
+    char *slab = new_slab(size + align);
+    p = (reinterpret_cast<std::uintptr_t>(slab) + align - 1) & mask;
+    return reinterpret_cast<void *>(p);
+  }
+  cur_ = new_slab(next_slab_size_);
+  end_ = cur_ + next_slab_size_;
+  if (next_slab_size_ < MaxSlabSize) {
+    next_slab_size_ *= 2;
+  }
+  p = (reinterpret_cast<std::uintptr_t>(cur_) + align - 1) & mask;
+  cur_ = reinterpret_cast<char *>(p + size);
+  return reinterpret_cast<void *>(p);
+}
+
+/*!
+ *@brief 获取所有对象已分配的字节数
+ *@return 字节数
+ */
+std::size_t Arena::get_bytes_used() const {
+  std::size_t total = 0;
+  for (int i = 0; i < NumKinds; i++) {
+    total += bytes_used_[i];
+  }
+  return total;
+}
+
+/*!
+ *@brief 获取对象种类的名称
+ *@param kind 对象种类
+ *@return 名称字符串
+ */
+const char *Arena::get_kind_name(Kind kind) {
+  switch (kind) {
+  case TypeKind:
+    return "type";
+  case ConstantKind:
+    return "constant";
+  case GlobalVariableKind:
+    return "global variable";
+  case FunctionKind:
+    return "function";
+  case ArgumentKind:
+    return "argument";
+  case BasicBlockKind:
+    return "basic block";
+  case InstructionKind:
+    return "instruction";
+  case OperandKind:
+    return "operand";
+  case StringKind:
+    return "string";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+/*!
+ *@brief 打印多个内存池合计的各种类内存占用
+ *@param arenas 内存池
+ *@return 字符串，每个种类一行
+ */
+std::string Arena::print_usage(const std::vector<const Arena *> &arenas) {
+  std::string usage;
+  std::size_t used = 0;
+  std::size_t reserved = 0;
+  for (int i = 0; i < NumKinds; i++) {
+    std::size_t bytes = 0;
+    for (auto arena : arenas) {
+      bytes += arena->bytes_used_[i];
+    }
+    used += bytes;
+    usage += get_kind_name(static_cast<Kind>(i));
+    usage += ": ";
+    usage += std::to_string(bytes);
+    usage += " bytes\n";
+  }
+  for (auto arena : arenas) {
+    reserved += arena->bytes_reserved_;
+  }
+  usage += "total: ";
+  usage += std::to_string(used);
+  usage += " bytes used, ";
+  usage += std::to_string(reserved);
+  usage += " bytes reserved\n";
+  return usage;
+}
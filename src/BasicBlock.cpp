@@ -26,7 +26,7 @@
  */
 BasicBlock::BasicBlock(Module *m, const std::string &name = "",
                        Function *parent = nullptr, bool fake = false)
-    : Value(Type::get_label_type(m), name), parent_(parent), _fake(fake) {
+    : Value(Type::get_label_type(m), Value::BasicBlockVal, name), parent_(parent), _fake(fake) {
   assert(parent && "currently parent should not be nullptr");
   parent_->add_basic_block(this);
 }
@@ -37,23 +37,12 @@ BasicBlock::BasicBlock(Module *m, const std::string &name = "",
  *@note
  *----------
  *在基本块的尾部添加指令
- *&emsp; 设置待添加的指令后缀为空
- *&emsp; **if** 如果指令链表为空
- *&emsp;&emsp; 设置指令为后继为空
- *&emsp;&emsp; 不为空，则获取指令链表的最后一个指令
- *&emsp;&emsp; 设置插入指令的前继为最后一个指令
- *&emsp;&emsp; 最后一个指令后继为待插入指令
- *&emsp; 尾部插入指令
+ *&emsp; 设置指令的从属基本块
+ *&emsp; 尾部插入侵入式指令链表，O(1)
  */
 void BasicBlock::add_instruction(Instruction *instr) {
-  instr->setSuccInst(nullptr);
-  if (instr_list_.empty()) {
-    instr->setSuccInst(nullptr);
-  } else {
-    Instruction *last_inst = instr_list_.back();
-    instr->setPrevInst(last_inst);
-    last_inst->setSuccInst(instr);
-  }
+  invalidate_numbering();
+  instr->set_parent(this);
   instr_list_.push_back(instr);
 }
 
@@ -80,23 +69,12 @@ void BasicBlock::add_instruction(Instruction *instr) {
  *@note
  *----------
  *在基本块的头部添加指令
- *&emsp; 设置待添加的指令前继为空
- *&emsp; **if** 如果指令链表为空
- *&emsp;&emsp; 设置指令为后继为空
- *&emsp;&emsp; 不为空，则获取指令链表的第一个指令
- *&emsp;&emsp; 设置插入指令的后继为第一个指令
- *&emsp;&emsp; 第一个指令前继为待插入指令
- *&emsp; 头部插入指令
+ *&emsp; 设置指令的从属基本块
+ *&emsp; 头部插入侵入式指令链表，O(1)
  */
 void BasicBlock::add_instr_begin(Instruction *instr) {
-  instr->setPrevInst(nullptr);
-  if (instr_list_.empty()) {
-    instr->setSuccInst(nullptr);
-  } else {
-    Instruction *first_inst = instr_list_.front();
-    instr->setSuccInst(first_inst);
-    first_inst->setPrevInst(instr);
-  }
+  invalidate_numbering();
+  instr->set_parent(this);
   instr_list_.push_front(instr);
 }
 
@@ -107,13 +85,11 @@ void BasicBlock::add_instr_begin(Instruction *instr) {
  *----------
  *向phi指令后添加指令
  *&emsp; 设置指令的从属基本块
- *&emsp; 获取指令链表的开始
- *&emsp;&emsp; **for** 循环，遍历获得phi指令点
- *&emsp; **if** 如果不是链表头，phi节点前继为节点前继
- *&emsp; **if** 如果不是链表尾，phi节点后继设置为节点本身
- *&emsp; 修正插入节点的连接关系，前继和后继的修改
+ *&emsp; 跳过块首的phi指令，只扫描phi部分
+ *&emsp; 在第一条非phi指令之前插入，O(1)
  */
 void BasicBlock::add_instr_after_phi(Instruction *instr) {
+  invalidate_numbering();
   instr->set_parent(this);
   auto it = instr_list_.begin();
   //遍历获得phi指令点
@@ -122,56 +98,131 @@ void BasicBlock::add_instr_after_phi(Instruction *instr) {
       break;
     }
   }
-  //获取插入点
-  Instruction *front = nullptr, *back = nullptr;
-  if (it != instr_list_.begin()) {
-    front = *(--it);
-    ++it;
-  }
-  if (it != instr_list_.end()) {
-    back = *it;
-  }
-  if (front != nullptr) {
-    front->setSuccInst(instr);
-  }
-  if (back != nullptr) {
-    back->setPrevInst(instr);
-  }
-  // 设置待插入节点的前后继
-  instr->setPrevInst(front);
-  instr->setSuccInst(back);
   instr_list_.insert(it, instr);
 }
 
+/*!
+ *@brief 在指定指令之前插入指令
+ *@param pos 基本块中的指令
+ *@param instr 不在任何基本块中的指令
+ *@note
+ *----------
+ *O(1)，设置指令的从属基本块
+ */
+void BasicBlock::insert_instr_before(Instruction *pos, Instruction *instr) {
+  assert(pos->get_parent() == this && "insert position not in this block");
+  invalidate_numbering();
+  instr->set_parent(this);
+  instr_list_.insert_before(pos, instr);
+}
+
+/*!
+ *@brief 在指定指令之后插入指令
+ *@param pos 基本块中的指令
+ *@param instr 不在任何基本块中的指令
+ *@note
+ *----------
+ *O(1)，设置指令的从属基本块
+ */
+void BasicBlock::insert_instr_after(Instruction *pos, Instruction *instr) {
+  assert(pos->get_parent() == this && "insert position not in this block");
+  invalidate_numbering();
+  instr->set_parent(this);
+  instr_list_.insert_after(pos, instr);
+}
+
+/*!
+ *@brief 将from中[first, last)的指令移动到pos之前
+ *@param pos 本基本块中的插入位置
+ *@param from 源基本块，可以是本基本块
+ *@param first 区间起点
+ *@param last 区间终点
+ *@note
+ *----------
+ *链表指针修改为O(1)，跨基本块时逐条修改指令的从属基本块
+ */
+void BasicBlock::splice(InstList::iterator pos, BasicBlock *from,
+                        InstList::iterator first, InstList::iterator last) {
+  invalidate_numbering();
+  std::size_t n = 0;
+  if (from != this) {
+    from->invalidate_numbering();
+    for (auto it = first; it != last; ++it) {
+      (*it)->set_parent(this);
+      n++;
+    }
+  }
+  instr_list_.splice(pos, from->instr_list_, first, last, n);
+}
+
 /*!
  *@brief 删除基本块中的某个指令
  *@param 待删除的指令指针
  *@note
  *----------
- *&emsp; 删除维护的指令链表中的指令
- *&emsp; 获取删除的指令的前后指令
- *&emsp; 修正指令的链接关系：
- *&emsp; **if** 如果前置指令不为空
- *&emsp;&emsp; 为前置指令设置新的后置指令
- *&emsp; **if** 如果后置指令不为空
- *&emsp;&emsp; 为后置指令设置新的前置指令
+ *&emsp; 从侵入式指令链表中摘除指令，O(1)
  *&emsp; 被删除的指令进行相关use的删除
+ *&emsp; 指令对象保留，回收内存使用Instruction::erase_from_parent
  */
 void BasicBlock::delete_instr(Instruction *instr) {
+  invalidate_numbering();
   instr_list_.remove(instr);
-  Instruction *prev = instr->getPrevInst();
-  Instruction *succ = instr->getSuccInst();
-  //修正指令的链接关系
-  if (prev != nullptr) {
-    prev->setSuccInst(succ);
-  }
-  if (succ != nullptr) {
-    succ->setPrevInst(prev);
-  }
   //被删除的指令进行相关use的删除
   instr->remove_use_of_ops();
 }
 
+/*!
+ *@brief 返回基本块在所属函数内的稠密编号
+ *@return 编号
+ */
+unsigned BasicBlock::get_number() const {
+  assert(parent_->has_numbering() && "function numbering is stale");
+  return number_;
+}
+
+/*!
+ *@brief 指令链表修改后使所属函数的编号失效
+ */
+void BasicBlock::invalidate_numbering() { parent_->invalidate_numbering(); }
+
+/*!
+ *@brief 返回基本块的后置基本块
+ *@return 后置基本块向量
+ *@note
+ *----------
+ *由终结指令中类型为基本块的operand推导，顺序与operand一致
+ */
+BasicBlock::BBVector BasicBlock::get_succ_basic_blocks() const {
+  BBVector succs;
+  const Instruction *term = get_terminator();
+  if (term == nullptr) {
+    return succs;
+  }
+  for (auto op : term->get_operands()) {
+    if (auto bb = dyn_cast_or_null<BasicBlock>(op)) {
+      succs.push_back(bb);
+    }
+  }
+  return succs;
+}
+
+/*!
+ *@brief 跳转指令的目标operand摘链时删除前置基本块
+ *@param bb 跳转指令所在的基本块
+ *@note
+ *----------
+ *只删除一次出现，保持其余前置基本块的顺序
+ */
+void BasicBlock::remove_pre_basic_block(BasicBlock *bb) {
+  for (auto it = pre_bbs_.begin(); it != pre_bbs_.end(); ++it) {
+    if (*it == bb) {
+      pre_bbs_.erase(it);
+      return;
+    }
+  }
+  assert(0 && "predecessor not found");
+}
+
 /*!
  *@brief 获取基本块内的终结指令
  *@return 终结指令常量指针
@@ -208,56 +259,52 @@ const Instruction *BasicBlock::get_terminator() const {
 
 /*!
  *@brief 打印基本块
- *@return 待打印的字符串
+ *@param os 输出流
  *@note
  *----------
  *return parent, or null if none.
  *&emsp; 如果基本块为假，那么输出空
- *&emsp; 定义输出字符串string
  *&emsp; 添加基本块名称，
  *&emsp; 添加前置基本块的说明，依次打印前置基本块
  *&emsp; 隶属于函数则进行空行添加
  *&emsp; 依次打印维护的指令链表内容
  *&emsp; 如果基本块无终结指令，默认添加
  */
-std::string BasicBlock::print() {
+void BasicBlock::print_ir(OutStream &os) {
   if (_fake) {
-    return "";
+    return;
   }
-  std::string bb_ir;
-  bb_ir += this->get_name();
-  bb_ir += ":";
+  os << this->get_name();
+  os << ":";
   // print prebb
   if (!this->get_pre_basic_blocks().empty()) {
-    bb_ir += "                                                ; preds = ";
+    os << "                                                ; preds = ";
   }
   for (auto bb : this->get_pre_basic_blocks()) {
     if (bb != *this->get_pre_basic_blocks().begin())
-      bb_ir += ", ";
-    bb_ir += print_as_op(bb, false);
+      os << ", ";
+    print_as_op(os, bb, false);
   }
 
   // print func
   if (!this->get_parent()) {
-    bb_ir += "\n";
-    bb_ir += "; Error: Block without parent!";
+    os << "\n";
+    os << "; Error: Block without parent!";
   }
-  bb_ir += "\n";
+  os << "\n";
   for (auto instr : this->get_instructions()) {
-    bb_ir += "  ";
-    bb_ir += instr->print();
-    bb_ir += "\n";
+    os << "  ";
+    instr->print(os);
+    os << "\n";
   }
 
   // 空BasicBlock，自动加上return语句
   if (get_terminator() == nullptr) {
-    bb_ir += "  ";
+    os << "  ";
     if (get_parent()->get_return_type()->is_void_type()) {
-      bb_ir += "ret void\n";
+      os << "ret void\n";
     } else {
-      bb_ir += "ret i32 0\n";
+      os << "ret i32 0\n";
     }
   }
-
-  return bb_ir;
 }
\ No newline at end of file
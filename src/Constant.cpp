@@ -6,52 +6,83 @@
  */
 #include "Constant.h"
 #include "Module.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 /*!
- *@brief 常量整数类32位创建函数
+ *@brief 常量整数类32位获取函数
  *@param val 常量值
  *@param m 所属模块
- *@return 常量类对象指针
+ *@return 模块内唯一的常量类对象指针
  */
 ConstantInt *ConstantInt::get(int val, Module *m) {
-  return new ConstantInt(Type::get_int32_type(m), val);
+  return m->get_constant_context().get_int(val);
 }
 /*!
- *@brief 常量整数类1位创建函数
+ *@brief 常量整数类1位获取函数
  *@param val 常量值
  *@param m 所属模块
- *@return 常量类对象指针
+ *@return true/false单例
  */
 ConstantInt *ConstantInt::get(bool val, Module *m) {
-  return new ConstantInt(Type::get_int1_type(m), val ? 1 : 0);
+  return m->get_constant_context().get_bool(val);
 }
 /*!
  *@brief 打印常量类变量
- *@return 字符串
+ *@param os 输出流
  *@note
  *---------
  *获取常量类型
  *&emsp; **if** 判定为整数常量类型并且为1为的布尔类型，
  *&emsp;&emsp; 添加true/flase字符串
  *&emsp; 判定为32位类型
- *&emsp; 将其数组转换为字符串输出
- *&emsp; 返回字符串
+ *&emsp; 将其数值写入输出流
  */
-std::string ConstantInt::print() {
-  std::string const_ir;
+void ConstantInt::print_ir(OutStream &os) {
   Type *ty = this->get_type();
   if (ty->is_integer_type() &&
       static_cast<IntegerType *>(ty)->get_num_bits() == 1) {
     // int1
-    const_ir += (this->get_value() == 0) ? "false" : "true";
+    os << ((this->get_value() == 0) ? "false" : "true");
   } else {
     // int32
-    const_ir += std::to_string(this->get_value());
+    os << this->get_value();
   }
-  return const_ir;
 }
 
+namespace {
+/*!
+ *@brief 按LLVM的十六进制双精度格式打印float
+ *@param os 输出流
+ *@param f 元素值
+ *@note float可精确转换为double，十六进制保证打印结果无舍入，可原样读回
+ */
+void print_float(OutStream &os, float f) {
+  double d = f;
+  unsigned long long bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  os << "0x";
+  os.write_hex(bits, 16);
+}
+} // namespace
+
+/*!
+ *@brief 常量浮点数类获取函数
+ *@param val 常量值
+ *@param m 所属模块
+ *@return 模块内唯一的常量类对象指针
+ */
+ConstantFP *ConstantFP::get(float val, Module *m) {
+  return m->get_constant_context().get_float(val);
+}
+/*!
+ *@brief 打印常量浮点数
+ *@param os 输出流
+ */
+void ConstantFP::print_ir(OutStream &os) { print_float(os, value_); }
+
 /*!
  *@brief 常量整数类构造函数
  *@param ty 常量类型
@@ -60,7 +91,7 @@ std::string ConstantInt::print() {
  *constant int array
  */
 ConstantArray::ConstantArray(ArrayType *ty, const std::vector<Constant *> &val)
-    : Constant(ty, "", val.size()) {
+    : Constant(ty, Value::ConstantArrayVal, "", val.size()) {
   for (int i = 0; i < (int)val.size(); i++)
     set_operand(i, val[i]);
   this->const_array.assign(val.begin(), val.end());
@@ -83,40 +114,475 @@ Constant *ConstantArray::get_element_value(int index) {
  */
 ConstantArray *ConstantArray::get(ArrayType *ty,
                                   const std::vector<Constant *> &val) {
-  return new ConstantArray(ty, val);
+  return ty->get_module()->get_constant_context().get_array(ty, val);
 }
 /*!
  *@brief 常量数组类打印函数
- *@return 字符串
+ *@param os 输出流
  *constant int array
  */
-std::string ConstantArray::print() {
-  std::string const_ir;
-  const_ir += "[";
+void ConstantArray::print_ir(OutStream &os) {
+  os << "[";
   for (int i = 0; i < static_cast<int>(this->get_size_of_array()); i++) {
-    const_ir += get_element_value(i)->get_type()->print();
-    const_ir += " ";
-    const_ir += get_element_value(i)->print();
-    const_ir += ", ";
+    if (i) {
+      os << ", ";
+    }
+    os << get_element_value(i)->get_type()->print();
+    os << " ";
+    get_element_value(i)->print(os);
+  }
+  os << "]";
+}
+namespace {
+/*!
+ *@brief 嵌套初值构建器
+ *@note
+ *---------
+ *自外向内递归，每一维使用一个复用的元素缓冲，不复制中间结果；
+ *最内层的行直接作为紧凑常量数组，不创建逐元素的整数常量；
+ *行与子数组经常量上下文唯一化，重复的行只保存一份
+ */
+class InitBuilder {
+private:
+  const int *data_;                            // 展平的初值
+  bool share_;                                 // 行是否直接引用data_
+  std::vector<std::vector<Constant *>> elems_; // 各维的元素缓冲
+
+public:
+  /*!
+   *@brief 构建器构造函数
+   *@param data 展平的初值
+   *@param depth 数组的维数
+   *@param share 行是否直接引用data而不复制
+   */
+  InitBuilder(const int *data, unsigned depth, bool share = false)
+      : data_(data), share_(share), elems_(depth) {}
+
+  /*!
+   *@brief 构建一个子数组
+   *@param ty 子数组类型
+   *@param begin 子数组在展平初值中的起点
+   *@param depth 子数组所在的维
+   *@return 全零时为ConstantZero，否则为常量数组或紧凑常量数组
+   */
+  Constant *build(ArrayType *ty, std::size_t begin, unsigned depth) {
+    Module *m = ty->get_module();
+    Type *elem = ty->get_element_type();
+    if (!elem->is_array_type()) {
+      const int *row = data_ + begin;
+      unsigned n = ty->get_num_of_elements();
+      if (std::all_of(row, row + n, [](int v) { return v == 0; })) {
+        return ConstantZero::get(ty, m);
+      }
+      return share_ ? ConstantDataArray::get_shared(ty, row, n)
+                    : ConstantDataArray::get(ty, row, n);
+    }
+    auto sub_ty = static_cast<ArrayType *>(elem);
+    std::size_t stride = sub_ty->get_num_of_flat_elements();
+    auto &elems = elems_[depth];
+    elems.clear();
+    bool all_zero = true;
+    for (unsigned i = 0; i < ty->get_num_of_elements(); i++) {
+      Constant *c = build(sub_ty, begin + i * stride, depth + 1);
+      all_zero &= isa<ConstantZero>(c);
+      elems.push_back(c);
+    }
+    if (all_zero) {
+      return ConstantZero::get(ty, m);
+    }
+    return ConstantArray::get(ty, elems);
   }
-  const_ir.pop_back();
-  const_ir.pop_back();
-  const_ir += "]";
-  return const_ir;
+};
+
+/*!
+ *@brief 获取数组的维数
+ *@param ty 数组类型
+ *@return 维数
+ */
+unsigned get_array_depth(Type *ty) {
+  unsigned depth = 0;
+  for (; ty->is_array_type(); ty = ty->get_array_element_type()) {
+    depth++;
+  }
+  return depth;
 }
+} // namespace
+
+/*!
+ *@brief 由展平的初值一次构建嵌套常量
+ *@param ty 数组类型
+ *@param data 按行优先展平的元素
+ *@param n 元素个数
+ *@param share 行是否直接引用data而不复制
+ *@return 全零时为ConstantZero，否则为嵌套常量数组
+ *constant int array
+ */
+Constant *ConstantArray::build(ArrayType *ty, const int *data, std::size_t n,
+                               bool share) {
+  assert(ty->get_scalar_type()->is_int32_type() && "not an int32 array type");
+  assert(n == ty->get_num_of_flat_elements() &&
+         "initializer size does not match the array type");
+  return InitBuilder(data, get_array_depth(ty), share).build(ty, 0, 0);
+}
+
 /*!
  *@brief 常量整数类构造函数
+ *@param dim 常量类型
+ *@param init 初始化数组
+ *@param m 所属数组
+ *@return 常量类指针数组
+ *@note
+ *---------
+ *一维时逐元素返回整数常量；
+ *多维时按第一维分组，每组经ConstantArray::build一次构建
+ *constant int array
+ */
+std::vector<Constant *>
+ConstantArray::IntegerList2Constant(const std::vector<int> &dim,
+                                   const std::vector<int> &init, Module *m) {
+  std::vector<Constant *> ost;
+  if (dim.size() <= 1) {
+    ost.reserve(init.size());
+    for (int i : init) {
+      ost.push_back(ConstantInt::get(i, m));
+    }
+    return ost;
+  }
+  Type *ty = Type::get_int32_type(m);
+  for (int i = (int)dim.size() - 1; i > 0; --i) {
+    ty = ArrayType::get(ty, dim[i]);
+  }
+  auto group_ty = static_cast<ArrayType *>(ty);
+  std::size_t group_size = group_ty->get_num_of_flat_elements();
+  InitBuilder builder(init.data(), dim.size() - 1);
+  for (std::size_t begin = 0; begin + group_size <= init.size();
+       begin += group_size) {
+    ost.push_back(builder.build(group_ty, begin, 0));
+  }
+  return ost;
+}
+/*!
+ *@brief 获取唯一的紧凑常量数组
+ *@param ty 数组类型
+ *@param data 元素存储
+ *@param n 元素个数
+ *@param elem_size 元素大小
+ *@param copy 新建时是否复制元素
+ *@return 紧凑常量数组指针
+ *@note 由常量上下文按内容唯一化，元素复制到模块内存池，随模块一并释放
+ *constant data array
+ */
+ConstantDataArray *ConstantDataArray::create(ArrayType *ty, const void *data,
+                                             std::size_t n,
+                                             std::size_t elem_size,
+                                             bool copy) {
+  assert(n == ty->get_num_of_flat_elements() &&
+         "initializer size does not match the array type");
+  return ty->get_module()->get_constant_context().get_data_array(
+      ty, data, n, elem_size, copy);
+}
+/*!
+ *@brief 创建int32紧凑常量数组
+ *@param ty 数组类型
+ *@param data 按行优先展平的元素
+ *@param n 元素个数
+ *@return 紧凑常量数组指针
+ *constant data array
+ */
+ConstantDataArray *ConstantDataArray::get(ArrayType *ty, const int *data,
+                                          std::size_t n) {
+  assert(ty->get_scalar_type()->is_int32_type() && "not an int32 array type");
+  return create(ty, data, n, sizeof(int));
+}
+/*!
+ *@brief 获取引用已有存储的int32紧凑常量数组
+ *@param ty 数组类型
+ *@param data 按行优先展平的元素，位于模块内存池
+ *@param n 元素个数
+ *@return 紧凑常量数组指针
+ *@note 内容已存在时返回已有对象，否则新建的对象直接引用data
+ *constant data array
+ */
+ConstantDataArray *ConstantDataArray::get_shared(ArrayType *ty,
+                                                 const int *data,
+                                                 std::size_t n) {
+  assert(ty->get_scalar_type()->is_int32_type() && "not an int32 array type");
+  return create(ty, data, n, sizeof(int), false);
+}
+/*!
+ *@brief 创建float紧凑常量数组
+ *@param ty 数组类型
+ *@param data 按行优先展平的元素
+ *@param n 元素个数
+ *@return 紧凑常量数组指针
+ *constant data array
+ */
+ConstantDataArray *ConstantDataArray::get(ArrayType *ty, const float *data,
+                                          std::size_t n) {
+  assert(ty->get_scalar_type()->is_float_type() && "not a float array type");
+  return create(ty, data, n, sizeof(float));
+}
+
+namespace {
+/*!
+ *@brief 按数组类型逐维打印紧凑常量数组
+ *@param os 输出流
+ *@param ty 当前维的数组类型
+ *@param arr 紧凑常量数组
+ *@param idx 下一个待打印元素的展平下标
+ *@note 最内层一维按元素类型分开循环，每个元素只做一次整数或浮点格式化
+ *constant data array
+ */
+void print_data_dim(OutStream &os, ArrayType *ty,
+                    const ConstantDataArray *arr, std::size_t &idx) {
+  Type *elem = ty->get_element_type();
+  std::string_view elem_ty = elem->print();
+  unsigned n = ty->get_num_of_elements();
+  os << "[";
+  if (elem->is_array_type()) {
+    for (unsigned i = 0; i < n; i++) {
+      if (i) {
+        os << ", ";
+      }
+      os << elem_ty << ' ';
+      print_data_dim(os, static_cast<ArrayType *>(elem), arr, idx);
+    }
+  } else if (elem->is_float_type()) {
+    const float *data = arr->get_float_data() + idx;
+    for (unsigned i = 0; i < n; i++) {
+      if (i) {
+        os << ", ";
+      }
+      os << elem_ty << ' ';
+      print_float(os, data[i]);
+    }
+    idx += n;
+  } else {
+    const int *data = arr->get_int_data() + idx;
+    for (unsigned i = 0; i < n; i++) {
+      if (i) {
+        os << ", ";
+      }
+      os << elem_ty << ' ' << data[i];
+    }
+    idx += n;
+  }
+  os << "]";
+}
+} // namespace
+
+/*!
+ *@brief 紧凑常量数组打印函数
+ *@param os 输出流
+ *@note 逐维直接写入输出流，不构造中间字符串
+ *constant data array
+ */
+void ConstantDataArray::print_ir(OutStream &os) {
+  std::size_t idx = 0;
+  print_data_dim(os, static_cast<ArrayType *>(get_type()), this, idx);
+}
+/*!
+ *@brief 从展平的元素中提取非零区间并创建常量
+ *@param ty 数组类型
+ *@param data 展平的元素
+ *@param n 元素个数
+ *@return 全零时为ConstantZero，否则为稀疏常量数组
+ *@note
+ *---------
+ *扫描一遍得到非零区间，间隔少于MinZeroGap的区间合并，避免区间过碎；
+ *区间与区间元素均复制到模块内存池
+ *constant sparse array
+ */
+Constant *ConstantSparseArray::create(ArrayType *ty, const unsigned *data,
+                                      std::size_t n) {
+  assert(n == ty->get_num_of_flat_elements() &&
+         "initializer size does not match the array type");
+  Module *m = ty->get_module();
+  std::vector<Run> runs;
+  std::size_t stored = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    if (data[i] == 0) {
+      continue;
+    }
+    if (!runs.empty() && i - runs.back().end() < MinZeroGap) {
+      stored += i + 1 - runs.back().end();
+      runs.back().size_ = i + 1 - runs.back().begin_;
+    } else {
+      runs.push_back({i, 1, stored});
+      stored++;
+    }
+  }
+  if (runs.empty()) {
+    return ConstantZero::get(ty, m);
+  }
+  auto run_buf = static_cast<Run *>(
+      m->allocate(sizeof(Run) * runs.size(), alignof(Run), Arena::ConstantKind));
+  std::memcpy(run_buf, runs.data(), sizeof(Run) * runs.size());
+  auto buf = static_cast<unsigned *>(
+      m->allocate(sizeof(unsigned) * stored, alignof(unsigned),
+                  Arena::ConstantKind));
+  for (auto &run : runs) {
+    std::memcpy(buf + run.offset_, data + run.begin_,
+                sizeof(unsigned) * run.size_);
+  }
+  return new (m, 0)
+      ConstantSparseArray(ty, run_buf, runs.size(), buf, n);
+}
+/*!
+ *@brief 创建int32稀疏常量数组
+ *@param ty 数组类型
+ *@param data 按行优先展平的元素
+ *@param n 元素个数
+ *@return 全零时为ConstantZero，否则为稀疏常量数组
+ *constant sparse array
+ */
+Constant *ConstantSparseArray::get(ArrayType *ty, const int *data,
+                                   std::size_t n) {
+  assert(ty->get_scalar_type()->is_int32_type() && "not an int32 array type");
+  return create(ty, reinterpret_cast<const unsigned *>(data), n);
+}
+/*!
+ *@brief 创建float稀疏常量数组
+ *@param ty 数组类型
+ *@param data 按行优先展平的元素
+ *@param n 元素个数
+ *@return 全零时为ConstantZero，否则为稀疏常量数组
+ *@note 只有+0.0视为零，-0.0作为显式元素保留
+ *constant sparse array
+ */
+Constant *ConstantSparseArray::get(ArrayType *ty, const float *data,
+                                   std::size_t n) {
+  static_assert(sizeof(float) == sizeof(unsigned), "float must be 32-bit");
+  assert(ty->get_scalar_type()->is_float_type() && "not a float array type");
+  return create(ty, reinterpret_cast<const unsigned *>(data), n);
+}
+/*!
+ *@brief 获取元素的原始4字节
+ *@param i 展平下标
+ *@return 原始值，区间外为0
+ *@note 在区间上二分查找
+ *constant sparse array
+ */
+unsigned ConstantSparseArray::get_bits(std::size_t i) const {
+  auto run = std::upper_bound(
+      runs_, runs_ + num_runs_, i,
+      [](std::size_t idx, const Run &r) { return idx < r.begin_; });
+  if (run == runs_) {
+    return 0;
+  }
+  --run;
+  if (i >= run->end()) {
+    return 0;
+  }
+  return static_cast<const unsigned *>(data_)[run->offset_ + i - run->begin_];
+}
+/*!
+ *@brief 获取int32元素
+ *@param i 展平下标
+ *@return 元素值
+ *constant sparse array
+ */
+int ConstantSparseArray::get_int(std::size_t i) const {
+  assert(get_element_type()->is_int32_type() && "not an int32 array");
+  return static_cast<int>(get_bits(i));
+}
+/*!
+ *@brief 获取float元素
+ *@param i 展平下标
+ *@return 元素值
+ *constant sparse array
+ */
+float ConstantSparseArray::get_float(std::size_t i) const {
+  assert(get_element_type()->is_float_type() && "not a float array");
+  unsigned bits = get_bits(i);
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+namespace {
+/*!
+ *@brief 按数组类型逐维打印稀疏常量数组
+ *@param os 输出流
+ *@param ty 当前维的数组类型
+ *@param arr 稀疏常量数组
+ *@param begin 当前子数组的展平起点
+ *@param run 不早于当前子数组的第一个区间，随打印单调前移
+ *@note 子数组与所有区间都不相交时打印zeroinitializer
+ *constant sparse array
+ */
+void print_sparse_dim(OutStream &os, ArrayType *ty,
+                      const ConstantSparseArray *arr, std::size_t begin,
+                      unsigned &run) {
+  std::size_t end = begin + ty->get_num_of_flat_elements();
+  while (run < arr->get_num_runs() && arr->get_run(run).end() <= begin) {
+    run++;
+  }
+  if (run == arr->get_num_runs() || arr->get_run(run).begin_ >= end) {
+    os << "zeroinitializer";
+    return;
+  }
+  Type *elem = ty->get_element_type();
+  std::string_view elem_ty = elem->print();
+  std::size_t stride =
+      elem->is_array_type()
+          ? static_cast<ArrayType *>(elem)->get_num_of_flat_elements()
+          : 1;
+  os << "[";
+  for (unsigned i = 0; i < ty->get_num_of_elements(); i++) {
+    if (i) {
+      os << ", ";
+    }
+    os << elem_ty << " ";
+    std::size_t idx = begin + i * stride;
+    if (elem->is_array_type()) {
+      print_sparse_dim(os, static_cast<ArrayType *>(elem), arr, idx, run);
+      continue;
+    }
+    while (run < arr->get_num_runs() && arr->get_run(run).end() <= idx) {
+      run++;
+    }
+    bool explicit_elem =
+        run < arr->get_num_runs() && arr->get_run(run).begin_ <= idx;
+    if (elem->is_float_type()) {
+      print_float(os, explicit_elem
+                          ? arr->get_run_floats(arr->get_run(run))
+                                [idx - arr->get_run(run).begin_]
+                          : 0.0f);
+    } else {
+      os << (explicit_elem ? arr->get_run_ints(arr->get_run(run))
+                                 [idx - arr->get_run(run).begin_]
+                           : 0);
+    }
+  }
+  os << "]";
+}
+} // namespace
+
+/*!
+ *@brief 稀疏常量数组打印函数
+ *@param os 输出流
+ *@note 按区间顺序单调推进，整体线性于打印的元素个数
+ *constant sparse array
+ */
+void ConstantSparseArray::print_ir(OutStream &os) {
+  unsigned run = 0;
+  print_sparse_dim(os, static_cast<ArrayType *>(get_type()), this, 0, run);
+}
+
+/*!
+ *@brief 获取零值常量
  *@param ty 常量类型
- *@param val 常量数值类型数组
- *@return 自身类对象
+ *@param m 所属模块
+ *@return 模块内每种类型唯一的零值常量
  *constant int zero
  */
 ConstantZero *ConstantZero::get(Type *ty, Module *m) {
-  return new ConstantZero(ty);
+  return m->get_constant_context().get_zero(ty);
 }
 /*!
  *@brief 打印常量零值
- *@return 字符串
+ *@param os 输出流
  *constant int zero
  */
-std::string ConstantZero::print() { return "zeroinitializer"; }
+void ConstantZero::print_ir(OutStream &os) { os << "zeroinitializer"; }
@@ -0,0 +1,205 @@
+/*!
+ *@file ConstantContext.cpp
+ *@brief 常量上下文接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#include "ConstantContext.h"
+#include "Constant.h"
+#include "Module.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+/*!
+ *@brief 整数常量键的散列
+ *@param key 类型与数值
+ *@return 散列值
+ */
+std::size_t ConstantContext::IntKeyHash::operator()(const IntKey &key) const {
+  std::size_t seed = std::hash<Type *>()(key.first);
+  return seed ^ (std::hash<int>()(key.second) + 0x9e3779b97f4a7c15ULL +
+                 (seed << 6) + (seed >> 2));
+}
+
+/*!
+ *@brief 比较常量数组的键
+ *@param rhs 另一个键
+ *@return 类型与各元素指针均相同
+ */
+bool ConstantContext::ArrayKey::operator==(const ArrayKey &rhs) const {
+  return ty_ == rhs.ty_ && size_ == rhs.size_ &&
+         std::equal(elems_, elems_ + size_, rhs.elems_);
+}
+
+/*!
+ *@brief 常量数组键的散列
+ *@param key 类型与元素
+ *@return 散列值
+ *@note 元素已唯一化，按指针散列即可
+ */
+std::size_t
+ConstantContext::ArrayKeyHash::operator()(const ArrayKey &key) const {
+  std::size_t seed = std::hash<ArrayType *>()(key.ty_);
+  for (std::size_t i = 0; i < key.size_; i++) {
+    seed ^= std::hash<Constant *>()(key.elems_[i]) + 0x9e3779b97f4a7c15ULL +
+            (seed << 6) + (seed >> 2);
+  }
+  return seed;
+}
+
+/*!
+ *@brief 比较紧凑常量数组的键
+ *@param rhs 另一个键
+ *@return 类型与元素字节均相同
+ */
+bool ConstantContext::DataKey::operator==(const DataKey &rhs) const {
+  return ty_ == rhs.ty_ && bytes_ == rhs.bytes_ &&
+         std::memcmp(data_, rhs.data_, bytes_) == 0;
+}
+
+/*!
+ *@brief 紧凑常量数组键的散列
+ *@param key 类型与元素字节
+ *@return 散列值
+ */
+std::size_t ConstantContext::DataKeyHash::operator()(const DataKey &key) const {
+  std::size_t seed = std::hash<ArrayType *>()(key.ty_);
+  std::string_view bytes(static_cast<const char *>(key.data_), key.bytes_);
+  return seed ^ (std::hash<std::string_view>()(bytes) + 0x9e3779b97f4a7c15ULL +
+                 (seed << 6) + (seed >> 2));
+}
+
+/*!
+ *@brief 常量上下文构造函数，创建布尔常量
+ *@param m 所属模块
+ *@note 小整数槽全部置空，按需创建
+ */
+ConstantContext::ConstantContext(Module *m) : m_(m) {
+  for (auto &slot : small_ints_) {
+    slot.store(nullptr, std::memory_order_relaxed);
+  }
+  false_ = new (m, 0) ConstantInt(m->get_int1_type(), 0);
+  true_ = new (m, 0) ConstantInt(m->get_int1_type(), 1);
+}
+
+/*!
+ *@brief 获取32位整数常量
+ *@param val 常量值
+ *@return 模块内唯一的常量对象指针
+ *@note
+ *---------
+ *小整数直接索引，无需散列；其余整数查(类型, 数值)散列表，未命中时创建；
+ *多个线程同时首次获取同一小整数时，只有比较交换成功的一个被发布
+ */
+ConstantInt *ConstantContext::get_int(int val) {
+  IntegerType *ty = m_->get_int32_type();
+  if (val >= SmallIntMin && val <= SmallIntMax) {
+    auto &slot = small_ints_[val - SmallIntMin];
+    ConstantInt *c = slot.load(std::memory_order_acquire);
+    if (c != nullptr) {
+      return c;
+    }
+    auto fresh = new (m_, 0) ConstantInt(ty, val);
+    if (slot.compare_exchange_strong(c, fresh, std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+      return fresh;
+    }
+    return c;
+  }
+  IntKey key{ty, val};
+  return ints_.get_or_create(key, [&] {
+    return std::make_pair(key, new (m_, 0) ConstantInt(ty, val));
+  });
+}
+
+/*!
+ *@brief 获取浮点数常量
+ *@param val 常量值
+ *@return 位模式相同时返回同一对象
+ *@note 按位模式比较，0.0与-0.0不合并，NaN也能找到自身
+ */
+ConstantFP *ConstantContext::get_float(float val) {
+  static_assert(sizeof(float) == sizeof(std::uint32_t), "float must be 32-bit");
+  std::uint32_t bits;
+  std::memcpy(&bits, &val, sizeof(bits));
+  return floats_.get_or_create(bits, [&] {
+    return std::make_pair(bits,
+                          new (m_, 0) ConstantFP(m_->get_float_type(), val));
+  });
+}
+
+/*!
+ *@brief 获取零值常量
+ *@param ty 常量类型
+ *@return 模块内每种类型唯一的零值常量
+ */
+ConstantZero *ConstantContext::get_zero(Type *ty) {
+  return zeros_.get_or_create(ty, [&] {
+    return std::make_pair(ty, new (m_, 0) ConstantZero(ty));
+  });
+}
+
+/*!
+ *@brief 获取常量数组
+ *@param ty 数组类型
+ *@param elems 元素
+ *@return 类型与元素相同时返回同一对象
+ *@note 查找键指向传入的元素；新建时键改为指向常量数组自身保存的元素
+ */
+ConstantArray *ConstantContext::get_array(ArrayType *ty,
+                                          const std::vector<Constant *> &elems) {
+  return arrays_.get_or_create({ty, elems.data(), elems.size()}, [&] {
+    auto arr = new (m_, elems.size()) ConstantArray(ty, elems);
+    return std::make_pair(ArrayKey{ty, arr->const_array.data(), elems.size()},
+                          arr);
+  });
+}
+
+/*!
+ *@brief 获取紧凑常量数组
+ *@param ty 数组类型
+ *@param data 展平的元素
+ *@param n 元素个数
+ *@param elem_size 元素大小
+ *@param copy 未命中时是否复制元素
+ *@return 类型与元素字节相同时返回同一对象
+ *@note
+ *---------
+ *查找键指向传入的元素；新建时元素复制到内存池，键改为指向池中元素；
+ *不复制时新建的数组与键直接引用传入的池中元素
+ */
+ConstantDataArray *ConstantContext::get_data_array(ArrayType *ty,
+                                                   const void *data,
+                                                   std::size_t n,
+                                                   std::size_t elem_size,
+                                                   bool copy) {
+  std::size_t bytes = n * elem_size;
+  return data_arrays_.get_or_create({ty, data, bytes}, [&] {
+    const void *buf = data;
+    if (copy) {
+      void *mem = m_->allocate(bytes, alignof(int), Arena::ConstantKind);
+      if (bytes != 0) {
+        std::memcpy(mem, data, bytes);
+      }
+      buf = mem;
+    }
+    auto arr = new (m_, 0) ConstantDataArray(ty, buf, n);
+    return std::make_pair(DataKey{ty, buf, bytes}, arr);
+  });
+}
+
+/*!
+ *@brief 获取已创建的整数常量个数
+ *@return 个数，不含布尔常量
+ */
+std::size_t ConstantContext::get_num_ints() {
+  std::size_t n = ints_.size();
+  for (auto &c : small_ints_) {
+    n += c.load(std::memory_order_acquire) != nullptr;
+  }
+  return n;
+}
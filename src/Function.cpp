@@ -19,7 +19,7 @@
  * @note 函数创建参数列表
  */
 Function::Function(FunctionType *ty, const std::string &name, Module *parent)
-    : Value(ty, name), parent_(parent), seq_cnt_(0) {
+    : Value(ty, Value::FunctionVal, name), parent_(parent), seq_cnt_(0) {
   parent->add_function(this);
   build_args();
 }
@@ -34,9 +34,16 @@ Function::Function(FunctionType *ty, const std::string &name, Module *parent)
  */
 Function *Function::create(FunctionType *ty, const std::string &name,
                            Module *parent) {
-  return new Function(ty, name, parent);
+  return new (parent) Function(ty, name, parent);
 }
 
+/**
+ * @brief Destroy the Function object
+ *
+ * @note 基本块与参数由所属模块统一析构
+ */
+Function::~Function() {}
+
 /**
  * @brief Get the function type object，获取函数的返回类型
  *
@@ -69,7 +76,10 @@ unsigned Function::get_num_of_args() const {
  *
  * @return unsigned ，函数管理的基本快数量
  */
-unsigned Function::get_num_basic_blocks() const { return basic_blocks_.size(); }
+unsigned Function::get_num_basic_blocks() const {
+  const_cast<Function *>(this)->materialize();
+  return basic_blocks_.size();
+}
 
 /**
  * @brief Get the parent object，获取函数所属模块
@@ -83,14 +93,14 @@ Module *Function::get_parent() const { return parent_; }
  *
  * @param bb 基本块指针
  * @note 删除phi节点对于基本块的使用
- * @note 删除前置基本块中对于该基本块的后继
- * @note 删除后继基本块中对于该基本块的前继
+ * @note 摘除终结指令的operand，后继基本块随之删除该前继
  */
 void Function::remove(BasicBlock *bb) {
   basic_blocks_.remove(bb);
+  invalidate_numbering();
   std::vector<PhiInst *> phis;
-  for (auto user : bb->get_use_list()) {
-    auto phi = dynamic_cast<PhiInst *>(user.val_);
+  for (auto &user : bb->get_use_list()) {
+    auto phi = dyn_cast<PhiInst>(user.val_);
     if (phi != nullptr) {
       phis.push_back(phi);
     }
@@ -99,13 +109,9 @@ void Function::remove(BasicBlock *bb) {
   for (auto phi : phis) {
     phi->remove_source(bb);
   }
-  /// 删除前置基本块中对于该基本块的后继
-  for (auto pre : bb->get_pre_basic_blocks()) {
-    pre->remove_succ_basic_block(bb);
-  }
-  /// 删除后继基本块中对于该基本块的前继
-  for (auto succ : bb->get_succ_basic_blocks()) {
-    succ->remove_pre_basic_block(bb);
+  /// 摘除终结指令对后继基本块的使用，后继基本块随之删除该前继
+  if (auto term = bb->get_terminator()) {
+    term->remove_use_of_ops();
   }
 }
 
@@ -120,16 +126,70 @@ void Function::build_args() {
   auto *func_ty = get_function_type();
   unsigned num_args = get_num_of_args();
   for (int i = 0; i < (int)num_args; i++) {
-    arguments_.push_back(new Argument(func_ty->get_param_type(i), "", this, i));
+    arguments_.push_back(
+        new (parent_) Argument(func_ty->get_param_type(i), "", this, i));
   }
 }
 
+/**
+ * @brief 经所属模块的读取器读取函数体
+ *
+ * @return true 读取成功
+ * @return false 函数体格式错误
+ * @note 先清除标记，读取时创建基本块与访问基本块不再重复读取
+ */
+bool Function::materialize_body() {
+  materializable_ = false;
+  return parent_->materialize(this);
+}
+
 /**
  * @brief 添加基本块
  *
  * @param bb 基本块指针
+ * @note 延迟加载的函数先读取函数体，新基本块排在原有基本块之后
  */
-void Function::add_basic_block(BasicBlock *bb) { basic_blocks_.push_back(bb); }
+void Function::add_basic_block(BasicBlock *bb) {
+  materialize();
+  basic_blocks_.push_back(bb);
+  invalidate_numbering();
+}
+
+/**
+ * @brief 为指令分配内存
+ *
+ * @param size 字节数，包含operand槽
+ * @return void* 内存起始地址
+ * @note 按alignof(Use)对齐后确定大小档位
+ * @note 档位的空闲链表非空时取链表头，否则从模块内存池分配
+ */
+void *Function::allocate_instruction(std::size_t size) {
+  std::size_t cls = (size + alignof(Use) - 1) / alignof(Use);
+  if (cls < free_lists_.size() && free_lists_[cls] != nullptr) {
+    FreeNode *node = free_lists_[cls];
+    free_lists_[cls] = node->next_;
+    return node;
+  }
+  return parent_->allocate(cls * alignof(Use), alignof(Use),
+                           Arena::InstructionKind);
+}
+
+/**
+ * @brief 回收已删除指令的内存
+ *
+ * @param mem 内存起始地址
+ * @param size 字节数，与分配时一致
+ * @note 挂入对应档位空闲链表的头部，下一次同档位分配立即复用
+ */
+void Function::free_instruction(void *mem, std::size_t size) {
+  std::size_t cls = (size + alignof(Use) - 1) / alignof(Use);
+  if (cls >= free_lists_.size()) {
+    free_lists_.resize(cls + 1, nullptr);
+  }
+  FreeNode *node = static_cast<FreeNode *>(mem);
+  node->next_ = free_lists_[cls];
+  free_lists_[cls] = node;
+}
 
 /**
  * @brief Set the instr name object，为参数和基本块设置名称
@@ -138,103 +198,117 @@ void Function::add_basic_block(BasicBlock *bb) { basic_blocks_.push_back(bb); }
  * @note 针对函数内部的基本块设置名称，并针对每个基本块的指令设置名称
  */
 void Function::set_instr_name() {
+  /// 每个value只访问一次，按成功命名的个数递增序号即可，无需查表
+  unsigned named = 0;
+  materialize();
   /// 针对函数的参数设置名称，
-  std::map<Value *, int> seq;
   for (auto arg : this->get_args()) {
-    if (seq.find(arg) == seq.end()) {
-      auto seq_num = seq.size() + seq_cnt_;
-      if (arg->set_name("arg" + std::to_string(seq_num))) {
-        seq.insert({arg, seq_num});
-      }
+    if (arg->set_name("arg" + std::to_string(seq_cnt_ + named))) {
+      named++;
     }
   }
   /// 针对函数内部的基本块设置名称，并针对每个基本块的指令设置名称
   for (auto bb : basic_blocks_) {
-    if (seq.find(bb) == seq.end()) {
-      auto seq_num = seq.size() + seq_cnt_;
-      if (bb->set_name("label" + std::to_string(seq_num))) {
-        seq.insert({bb, seq_num});
-      }
+    if (bb->set_name("label" + std::to_string(seq_cnt_ + named))) {
+      named++;
     }
     for (auto instr : bb->get_instructions()) {
-      if (!instr->is_void() && seq.find(instr) == seq.end()) {
-        auto seq_num = seq.size() + seq_cnt_;
-        if (instr->set_name("op" + std::to_string(seq_num))) {
-          seq.insert({instr, seq_num});
-        }
+      if (!instr->is_void() &&
+          instr->set_name("op" + std::to_string(seq_cnt_ + named))) {
+        named++;
       }
     }
   }
-  seq_cnt_ += seq.size();
+  seq_cnt_ += named;
+}
+
+/**
+ * @brief 为参数、基本块和指令分配函数内的稠密编号
+ *
+ * @note 参数编号即参数位置，不随函数修改变化
+ * @note 依次遍历基本块与指令，各自从0开始连续编号
+ * @note 编号有效时不重复遍历
+ */
+void Function::compute_numbering() {
+  if (numbering_valid_) {
+    return;
+  }
+  materialize();
+  unsigned bb_no = 0;
+  unsigned instr_no = 0;
+  for (auto bb : basic_blocks_) {
+    bb->number_ = bb_no++;
+    for (auto instr : bb->get_instructions()) {
+      instr->number_ = instr_no++;
+    }
+  }
+  num_numbered_bbs_ = bb_no;
+  num_numbered_instrs_ = instr_no;
+  numbering_valid_ = true;
 }
 
 /**
  * @brief 打印函数
  *
- * @return std::string 字符串
+ * @param os 输出流
  * @note 判断函数是声明还是定义
  * @note 依次添加函数类型和名称
  * @note 函数为声明/定义，不同添加规则
  * @note 函数为声明，换行结束/为定义，依次打印基本块
  */
-std::string Function::print() {
+void Function::print_ir(OutStream &os) {
   set_instr_name();
-  std::string func_ir;
   if (this->is_declaration()) {
-    func_ir += "declare ";
+    os << "declare ";
   } else {
-    func_ir += "define ";
+    os << "define ";
   }
 
-  func_ir += this->get_return_type()->print();
-  func_ir += " ";
-  func_ir += print_as_op(this, false);
-  func_ir += "(";
+  os << this->get_return_type()->print();
+  os << " ";
+  print_as_op(os, this, false);
+  os << "(";
 
   // print arg
   if (this->is_declaration()) {
     for (int i = 0; i < static_cast<int>(this->get_num_of_args()); i++) {
       if (i)
-        func_ir += ", ";
-      func_ir += static_cast<FunctionType *>(this->get_type())
-                     ->get_param_type(i)
-                     ->print();
+        os << ", ";
+      os << static_cast<FunctionType *>(this->get_type())
+                ->get_param_type(i)
+                ->print();
     }
   } else {
     for (auto arg = this->arg_begin(); arg != arg_end(); arg++) {
       if (arg != this->arg_begin()) {
-        func_ir += ", ";
+        os << ", ";
       }
-      func_ir += static_cast<Argument *>(*arg)->print();
+      static_cast<Argument *>(*arg)->print(os);
     }
   }
-  func_ir += ")";
+  os << ")";
 
   // print bb
   if (this->is_declaration()) {
-    func_ir += "\n";
+    os << "\n";
   } else {
-    func_ir += " {";
-    func_ir += "\n";
+    os << " {";
+    os << "\n";
     for (auto bb : this->get_basic_blocks()) {
-      func_ir += bb->print();
+      bb->print(os);
     }
-    func_ir += "}";
+    os << "}";
   }
-
-  return func_ir;
 }
 
 /**
  * @brief 打印参数列表
  *
- * @return std::string 字符串
+ * @param os 输出流
  * @note 依次打印参数的类型和名称
  */
-std::string Argument::print() {
-  std::string arg_ir;
-  arg_ir += this->get_type()->print();
-  arg_ir += " %";
-  arg_ir += this->get_name();
-  return arg_ir;
+void Argument::print_ir(OutStream &os) {
+  os << this->get_type()->print();
+  os << " %";
+  os << this->get_name();
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include "GlobalVariable.h"
 #include "IRprinter.h"
 
+#include <algorithm>
+#include <cassert>
+
 /*!
  *@brief 全局变量的构造函数
  *@param name 全局变量名称
@@ -22,11 +25,16 @@
  */
 GlobalVariable::GlobalVariable(std::string name, Module *m, Type *ty,
                                bool is_const, Constant *init)
-    : User(ty, name, init != nullptr), is_const_(is_const), init_val_(init) {
+    : User(ty, Value::GlobalVariableVal, name, init != nullptr), is_const_(is_const), init_val_(init) {
   m->add_global_variable(this);
   if (init) {
     this->set_operand(0, init);
   }
+  auto data = dyn_cast_or_null<ConstantDataArray>(init);
+  if (data != nullptr && data->get_element_type()->is_int32_type()) {
+    flat_data_ = data->get_int_data();
+    flat_size_ = data->get_num_elements();
+  }
 } // global操作数为initval
 
 /*!
@@ -45,27 +53,134 @@ GlobalVariable::GlobalVariable(std::string name, Module *m, Type *ty,
 GlobalVariable *GlobalVariable::create(std::string name, Module *m, Type *ty,
                                        bool is_const,
                                        Constant *init = nullptr) {
-  return new GlobalVariable(name, m, PointerType::get(ty), is_const, init);
+  return new (m, init != nullptr)
+      GlobalVariable(name, m, PointerType::get(ty), is_const, init);
+}
+
+/*!
+ *@brief 由扁平化初值创建全局数组
+ *@param name 全局变量名称
+ *@param m 所从属模块
+ *@param ty 变量的类型
+ *@param is_const 是否为常量
+ *@param flat 按行优先展平的初值
+ *@return 当前对象本身
+ *@note
+ *-------
+ *初值以紧凑常量数组保存，作为操作数并兼作扁平存储；
+ *嵌套初值置空，首次get_init时再由扁平存储构建
+ */
+GlobalVariable *GlobalVariable::create(std::string name, Module *m,
+                                       ArrayType *ty, bool is_const,
+                                       const std::vector<int> &flat) {
+  auto gv = create(name, m, ty, is_const, ConstantDataArray::get(ty, flat));
+  gv->init_val_ = nullptr;
+  return gv;
+}
+
+/*!
+ *@brief 获取初值
+ *@return 嵌套初值，无初值时为空
+ *@note 有初值操作数而嵌套初值尚未构建时，由扁平存储构建并缓存
+ */
+Constant *GlobalVariable::get_init() {
+  if (init_val_ == nullptr && get_num_operand() != 0) {
+    init_val_ = build_init_from_flatten();
+  }
+  return init_val_;
+}
+
+/*!
+ *@brief 扁平化数组的创建
+ *@param i 常量化的扁平数组
+ *@note
+ *--------
+ *有int32数组初值时，以新的紧凑常量数组替换初值操作数，
+ *扁平存储即其元素，嵌套初值置空，首次get_init时重新构建；
+ *没有数组初值时复制到模块内存池单独保存
+ */
+void GlobalVariable::setFlattenInit(const std::vector<int> &i) {
+  auto ty = get_type()->get_pointer_element_type();
+  auto aty = ty->is_array_type() ? static_cast<ArrayType *>(ty) : nullptr;
+  if (get_num_operand() != 0 && aty != nullptr &&
+      aty->get_scalar_type()->is_int32_type()) {
+    assert(aty->get_num_of_flat_elements() == i.size() &&
+           "flatten init does not match the array type");
+    auto data = ConstantDataArray::get(aty, i);
+    set_operand(0, data);
+    init_val_ = nullptr;
+    flat_data_ = data->get_int_data();
+    flat_size_ = data->get_num_elements();
+    return;
+  }
+  Module *m = get_type()->get_module();
+  auto buf = static_cast<int *>(m->allocate(
+      i.size() * sizeof(int), alignof(int), Arena::GlobalVariableKind));
+  std::copy(i.begin(), i.end(), buf);
+  flat_data_ = buf;
+  flat_size_ = i.size();
+}
+
+/*!
+ *@brief 获取扁平化数组
+ *@return 常量扁平化数组的视图
+ *@note
+ *--------
+ *紧凑常量数组本身即为扁平存储，直接引用其元素；
+ *稀疏常量数组在首次调用时按区间展开到模块内存池并缓存，
+ *无需另行调用setFlattenInit
+ */
+Span<int> GlobalVariable::getFlattenInit() const {
+  if (flat_data_ == nullptr) {
+    auto sparse = dyn_cast_or_null<ConstantSparseArray>(init_val_);
+    if (sparse != nullptr && sparse->get_element_type()->is_int32_type()) {
+      std::size_t n = sparse->get_num_elements();
+      Module *m = get_type()->get_module();
+      auto buf = static_cast<int *>(m->allocate(
+          n * sizeof(int), alignof(int), Arena::GlobalVariableKind));
+      std::fill(buf, buf + n, 0);
+      for (unsigned i = 0; i < sparse->get_num_runs(); i++) {
+        auto &run = sparse->get_run(i);
+        std::copy(sparse->get_run_ints(run),
+                  sparse->get_run_ints(run) + run.size_, buf + run.begin_);
+      }
+      flat_data_ = buf;
+      flat_size_ = n;
+    }
+  }
+  return Span<int>(flat_data_, flat_size_);
+}
+
+/*!
+ *@brief 由扁平化数组一次构建嵌套初值
+ *@return 全零时为ConstantZero，否则为嵌套常量数组
+ *@note
+ *--------
+ *全局变量的类型为指向数组的指针，按所指数组类型构建；
+ *扁平存储位于模块内存池且不再修改，各行直接引用而不复制
+ */
+Constant *GlobalVariable::build_init_from_flatten() const {
+  auto ty =
+      static_cast<ArrayType *>(get_type()->get_pointer_element_type());
+  auto flat = getFlattenInit();
+  return ConstantArray::build(ty, flat.data(), flat.size(), true);
 }
 
 /*!
  *@brief 打印全局变量
- *@return 字符串
+ *@param os 输出流
  *@note
  *--------
- *初始化字符串
  *添加名称
  *添加常量类型
  *添加数据指针所指向数据的类型
- *添加变量初值
+ *添加变量初值，直接写入输出流
  */
-std::string GlobalVariable::print() {
-  std::string global_val_ir;
-  global_val_ir += print_as_op(this, false);
-  global_val_ir += " = ";
-  global_val_ir += (this->is_const() ? "constant " : "global ");
-  global_val_ir += this->get_type()->get_pointer_element_type()->print();
-  global_val_ir += " ";
-  global_val_ir += this->get_init()->print();
-  return global_val_ir;
+void GlobalVariable::print_ir(OutStream &os) {
+  print_as_op(os, this, false);
+  os << " = ";
+  os << (this->is_const() ? "constant " : "global ");
+  os << this->get_type()->get_pointer_element_type()->print();
+  os << " ";
+  this->get_init()->print(os);
 }
\ No newline at end of file
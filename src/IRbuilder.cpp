@@ -0,0 +1,154 @@
+/*!
+ *@file IRbuilder.cpp
+ *@brief IR构建器接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+#include "IRbuilder.h"
+#include "Constant.h"
+
+namespace {
+/*!
+ *@brief 判断value是否为给定值的整数常量
+ *@param v value指针
+ *@param val 常量值
+ *@return 判定结果
+ */
+bool is_const_int(Value *v, int val) {
+  auto c = dyn_cast<ConstantInt>(v);
+  return c != nullptr && c->get_value() == val;
+}
+} // namespace
+
+/*!
+ *@brief 折叠整数二元运算
+ *@param op 运算类型
+ *@param lhs 左值指针
+ *@param rhs 右值指针
+ *@return 可折叠时为常量或已有操作数，否则为空
+ *@note
+ *---------
+ *两侧均为常量时直接计算，除零等运行期未定义的情况不折叠；
+ *否则按x+0、x-0、x*1、x/1得x，x*0、x-x、x%1得0化简
+ */
+Value *IRBuilder::fold_binary(Instruction::OpID op, Value *lhs, Value *rhs) {
+  auto cl = dyn_cast<ConstantInt>(lhs);
+  auto cr = dyn_cast<ConstantInt>(rhs);
+  if (cl != nullptr && cr != nullptr) {
+    if (!BinaryInst::is_foldable(op, cr->get_value())) {
+      return nullptr;
+    }
+    return ConstantInt::get(
+        BinaryInst::calculate(op, cl->get_value(), cr->get_value()), m_);
+  }
+  switch (op) {
+  case Instruction::add:
+    if (is_const_int(rhs, 0)) {
+      return lhs;
+    }
+    if (is_const_int(lhs, 0)) {
+      return rhs;
+    }
+    break;
+  case Instruction::sub:
+    if (is_const_int(rhs, 0)) {
+      return lhs;
+    }
+    if (lhs == rhs) {
+      return ConstantInt::get(0, m_);
+    }
+    break;
+  case Instruction::mul:
+    if (is_const_int(lhs, 0) || is_const_int(rhs, 0)) {
+      return ConstantInt::get(0, m_);
+    }
+    if (is_const_int(rhs, 1)) {
+      return lhs;
+    }
+    if (is_const_int(lhs, 1)) {
+      return rhs;
+    }
+    break;
+  case Instruction::sdiv:
+    if (is_const_int(rhs, 1)) {
+      return lhs;
+    }
+    break;
+  case Instruction::mod:
+    if (is_const_int(rhs, 1)) {
+      return ConstantInt::get(0, m_);
+    }
+    break;
+  default:
+    break;
+  }
+  return nullptr;
+}
+
+/*!
+ *@brief 折叠整数比较
+ *@param op 比较类型
+ *@param lhs 左值指针
+ *@param rhs 右值指针
+ *@return 可折叠时为布尔常量，否则为空
+ *@note 两侧为同一value时，==、>=、<=为真，其余为假
+ */
+Value *IRBuilder::fold_cmp(CmpInst::CmpOp op, Value *lhs, Value *rhs) {
+  auto cl = dyn_cast<ConstantInt>(lhs);
+  auto cr = dyn_cast<ConstantInt>(rhs);
+  if (cl != nullptr && cr != nullptr) {
+    return ConstantInt::get(
+        (bool)CmpInst::calculate(op, cl->get_value(), cr->get_value()), m_);
+  }
+  if (lhs == rhs) {
+    return ConstantInt::get(
+        op == CmpInst::EQ || op == CmpInst::GE || op == CmpInst::LE, m_);
+  }
+  return nullptr;
+}
+
+/*!
+ *@brief 创建整数二元运算
+ *@param op 运算类型
+ *@param lhs 左值指针
+ *@param rhs 右值指针
+ *@return 折叠结果或新建的指令
+ */
+Value *IRBuilder::create_binary(Instruction::OpID op, Value *lhs, Value *rhs) {
+  if (fold_) {
+    if (auto folded = fold_binary(op, lhs, rhs)) {
+      return folded;
+    }
+  }
+  switch (op) {
+  case Instruction::add:
+    return BinaryInst::create_add(lhs, rhs, this->BB_, m_);
+  case Instruction::sub:
+    return BinaryInst::create_sub(lhs, rhs, this->BB_, m_);
+  case Instruction::mul:
+    return BinaryInst::create_mul(lhs, rhs, this->BB_, m_);
+  case Instruction::sdiv:
+    return BinaryInst::create_sdiv(lhs, rhs, this->BB_, m_);
+  case Instruction::mod:
+    return BinaryInst::create_mod(lhs, rhs, this->BB_, m_);
+  default:
+    assert(0 && "not an integer binary op");
+    return nullptr;
+  }
+}
+
+/*!
+ *@brief 创建整数比较
+ *@param op 比较类型
+ *@param lhs 左值指针
+ *@param rhs 右值指针
+ *@return 折叠结果或新建的指令
+ */
+Value *IRBuilder::create_cmp(CmpInst::CmpOp op, Value *lhs, Value *rhs) {
+  if (fold_) {
+    if (auto folded = fold_cmp(op, lhs, rhs)) {
+      return folded;
+    }
+  }
+  return CmpInst::create_cmp(op, lhs, rhs, this->BB_, m_);
+}
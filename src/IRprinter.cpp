@@ -22,22 +22,32 @@
  */
 std::string print_as_op(Value *v, bool print_ty) {
   std::string op_ir;
+  StringOutStream os(op_ir);
+  print_as_op(os, v, print_ty);
+  return op_ir;
+}
+
+/*!
+ *@brief 将operand的名称打印到输出流
+ *@param os 输出流
+ *@param v operand
+ *@param print_ty 是否先打印类型
+ *@note 常量直接打印自身，不经中间字符串
+ */
+void print_as_op(OutStream &os, Value *v, bool print_ty) {
   if (print_ty) {
-    op_ir += v->get_type()->print();
-    op_ir += " ";
+    os << v->get_type()->print() << ' ';
   }
 
-  if (dynamic_cast<GlobalVariable *>(v)) {
-    op_ir += "@" + v->get_name();
-  } else if (dynamic_cast<Function *>(v)) {
-    op_ir += "@" + v->get_name();
-  } else if (dynamic_cast<Constant *>(v)) {
-    op_ir += v->print();
+  if (isa<GlobalVariable>(v)) {
+    os << '@' << v->get_name();
+  } else if (isa<Function>(v)) {
+    os << '@' << v->get_name();
+  } else if (isa<Constant>(v)) {
+    v->print(os);
   } else {
-    op_ir += "%" + v->get_name();
+    os << '%' << v->get_name();
   }
-
-  return op_ir;
 }
 
 /*!
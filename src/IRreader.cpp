@@ -0,0 +1,1017 @@
+/*!
+ *@file IRreader.cpp
+ *@brief 二进制中间代码读取器接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#include "IRbinary.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/*!
+ *@brief 映射文件的函数体读取器
+ *@note 持有文件映射与读取器，归延迟加载的模块所有，随模块析构时解除映射
+ */
+class MappedMaterializer : public Materializer {
+private:
+  void *data_;       // 映射起始
+  std::size_t size_; // 映射字节数
+  IRReader reader_;  // 读取器，字符串表与常量指向映射
+
+public:
+  MappedMaterializer(void *data, std::size_t size)
+      : data_(data), size_(size), reader_(data, size) {}
+  ~MappedMaterializer() override { ::munmap(data_, size_); }
+
+  IRReader &get_reader() { return reader_; }
+  bool materialize(Function *f) override { return reader_.materialize(f); }
+};
+
+/*!
+ *@brief 判断类型能否作为value的类型
+ *@param ty 类型指针
+ *@return 判定结果，void、label与函数类型不能
+ */
+bool is_value_type(Type *ty) {
+  return !ty->is_void_type() && !ty->is_label_type() &&
+         !ty->is_function_type();
+}
+} // namespace
+
+/*!
+ *@brief 读取LEB128变长编码的无符号数
+ *@return 读取的数，越界或超过64位时记录错误并返回0
+ */
+std::uint64_t IRReader::read_varint() {
+  std::uint64_t v = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (cur_ == end_) {
+      fail();
+      return 0;
+    }
+    unsigned char byte = *cur_++;
+    v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return v;
+    }
+  }
+  fail();
+  return 0;
+}
+
+/*!
+ *@brief 读取不超过上限的无符号数
+ *@param limit 上限，不含
+ *@return 读取的数，越界时记录错误并返回0
+ */
+unsigned IRReader::read_index(std::size_t limit) {
+  std::uint64_t v = read_varint();
+  if (v >= limit || v > UINT_MAX) {
+    fail();
+    return 0;
+  }
+  return static_cast<unsigned>(v);
+}
+
+/*!
+ *@brief 读取按4字节对齐存放的原始字节
+ *@param bytes 字节数
+ *@return 起始位置，越界时为空
+ *@note 对齐相对于输入起点计算，与写出时相对于文件起点一致
+ */
+const unsigned char *IRReader::read_aligned(std::size_t bytes) {
+  std::size_t pad = (4 - (cur_ - begin_) % 4) % 4;
+  if (static_cast<std::size_t>(end_ - cur_) < pad ||
+      static_cast<std::size_t>(end_ - cur_) - pad < bytes) {
+    fail();
+    return nullptr;
+  }
+  const unsigned char *data = cur_ + pad;
+  cur_ = data + bytes;
+  return data;
+}
+
+/*!
+ *@brief 读取名称引用
+ *@return 名称，无名称或越界时为空
+ */
+std::string_view IRReader::read_name() {
+  unsigned ref = read_index(strings_.size() + 1);
+  return ref == 0 ? std::string_view() : strings_[ref - 1];
+}
+
+/*!
+ *@brief 读取类型序号
+ *@return 类型指针，越界时为空
+ */
+Type *IRReader::read_type() {
+  unsigned id = read_index(types_.size());
+  return error_ ? nullptr : types_[id];
+}
+
+/*!
+ *@brief 读取魔数与版本
+ *@return 是否成功
+ */
+bool IRReader::read_header() {
+  if (static_cast<std::size_t>(end_ - cur_) < sizeof(IRBinaryFormat::Magic) ||
+      std::memcmp(cur_, IRBinaryFormat::Magic,
+                  sizeof(IRBinaryFormat::Magic)) != 0) {
+    return fail();
+  }
+  cur_ += sizeof(IRBinaryFormat::Magic);
+  if (read_varint() != IRBinaryFormat::Version) {
+    return fail();
+  }
+  return !error_;
+}
+
+/*!
+ *@brief 读取字符串表
+ *@return 是否成功
+ *@note 字符串直接指向输入，收录到模块时再复制
+ */
+bool IRReader::read_strings() {
+  std::size_t n = read_index(end_ - cur_ + 1);
+  strings_.reserve(n);
+  for (std::size_t i = 0; i < n && !error_; i++) {
+    std::uint64_t len = read_varint();
+    if (len > static_cast<std::uint64_t>(end_ - cur_)) {
+      return fail();
+    }
+    strings_.emplace_back(reinterpret_cast<const char *>(cur_), len);
+    cur_ += len;
+  }
+  return !error_;
+}
+
+/*!
+ *@brief 读取类型表
+ *@return 是否成功
+ *@note 组成类型排在前面，逐项经模块的类型上下文获取
+ */
+bool IRReader::read_types() {
+  std::size_t n = read_index(end_ - cur_ + 1);
+  types_.reserve(n);
+  for (std::size_t i = 0; i < n && !error_; i++) {
+    Type *ty = nullptr;
+    switch (read_varint()) {
+    case Type::VoidTyID:
+      ty = m_->get_void_type();
+      break;
+    case Type::LabelTyID:
+      ty = m_->get_label_type();
+      break;
+    case Type::IntegerTy1ID:
+      ty = m_->get_int1_type();
+      break;
+    case Type::IntegerTy32ID:
+      ty = m_->get_int32_type();
+      break;
+    case Type::FloatTyID:
+      ty = m_->get_float_type();
+      break;
+    case Type::FunctionTyID: {
+      Type *result = read_type();
+      std::size_t num_params = read_index(end_ - cur_ + 1);
+      std::vector<Type *> params;
+      for (std::size_t k = 0; k < num_params && !error_; k++) {
+        params.push_back(read_type());
+      }
+      if (error_ || !FunctionType::is_valid_return_type(result)) {
+        return fail();
+      }
+      ty = FunctionType::get(result, params);
+      break;
+    }
+    case Type::ArrayTyID: {
+      Type *elem = read_type();
+      unsigned num = read_index(UINT_MAX);
+      if (error_ || !ArrayType::is_valid_element_type(elem)) {
+        return fail();
+      }
+      ty = ArrayType::get(elem, num);
+      break;
+    }
+    case Type::PointerTyID: {
+      Type *elem = read_type();
+      if (error_) {
+        return false;
+      }
+      ty = PointerType::get(elem);
+      break;
+    }
+    default:
+      return fail();
+    }
+    types_.push_back(ty);
+  }
+  return !error_;
+}
+
+/*!
+ *@brief 读取常量表中的一项
+ *@param defer_scalar 是否只校验整数与浮点常量而暂不创建
+ *@return 常量指针，暂不创建或格式错误时为空
+ *@note
+ *---------
+ *整数、浮点数、零值、常量数组与紧凑常量数组经常量上下文唯一化；
+ *稀疏常量数组按记录的区间直接重建，不再扫描展开后的元素
+ */
+Constant *IRReader::read_constant(bool defer_scalar) {
+  unsigned tag = read_index(IRBinaryFormat::SparseArrayTag + 1);
+  Type *ty = read_type();
+  if (error_) {
+    return nullptr;
+  }
+  auto aty =
+      ty->is_array_type() ? static_cast<ArrayType *>(ty) : nullptr;
+  Constant *c = nullptr;
+  switch (tag) {
+  case IRBinaryFormat::IntTag: {
+    std::int64_t val = read_signed();
+    if (ty->is_int1_type() && (val == 0 || val == 1)) {
+      c = defer_scalar ? nullptr : ConstantInt::get(val != 0, m_);
+    } else if (ty->is_int32_type() && val >= INT_MIN && val <= INT_MAX) {
+      c = defer_scalar ? nullptr : ConstantInt::get(static_cast<int>(val), m_);
+    } else {
+      fail();
+      return nullptr;
+    }
+    break;
+  }
+  case IRBinaryFormat::FPTag: {
+    std::uint64_t bits = read_varint();
+    if (!ty->is_float_type() || bits > UINT32_MAX) {
+      fail();
+      return nullptr;
+    }
+    if (defer_scalar) {
+      break;
+    }
+    std::uint32_t word = static_cast<std::uint32_t>(bits);
+    float val;
+    std::memcpy(&val, &word, sizeof(val));
+    c = ConstantFP::get(val, m_);
+    break;
+  }
+  case IRBinaryFormat::ZeroTag:
+    c = ConstantZero::get(ty, m_);
+    break;
+  case IRBinaryFormat::ArrayTag: {
+    if (aty == nullptr ||
+        read_varint() != aty->get_num_of_elements()) {
+      fail();
+      return nullptr;
+    }
+    std::vector<Constant *> elems;
+    elems.reserve(aty->get_num_of_elements());
+    for (unsigned k = 0; k < aty->get_num_of_elements() && !error_; k++) {
+      Constant *elem = read_constant_ref();
+      if (!error_ && elem->get_type() != aty->get_element_type()) {
+        fail();
+        return nullptr;
+      }
+      elems.push_back(elem);
+    }
+    if (error_) {
+      return nullptr;
+    }
+    c = ConstantArray::get(aty, elems);
+    break;
+  }
+  case IRBinaryFormat::DataArrayTag: {
+    if (aty == nullptr || (!aty->get_scalar_type()->is_int32_type() &&
+                           !aty->get_scalar_type()->is_float_type())) {
+      fail();
+      return nullptr;
+    }
+    std::size_t num = aty->get_num_of_flat_elements();
+    const unsigned char *data = nullptr;
+    if (read_varint() != num || (data = read_aligned(num * 4)) == nullptr) {
+      fail();
+      return nullptr;
+    }
+    c = m_->get_constant_context().get_data_array(aty, data, num, 4,
+                                                  !lazy_);
+    break;
+  }
+  case IRBinaryFormat::SparseArrayTag: {
+    if (aty == nullptr || (!aty->get_scalar_type()->is_int32_type() &&
+                           !aty->get_scalar_type()->is_float_type())) {
+      fail();
+      return nullptr;
+    }
+    std::size_t num = aty->get_num_of_flat_elements();
+    if (read_varint() != num) {
+      fail();
+      return nullptr;
+    }
+    std::size_t num_runs = read_index(end_ - cur_ + 1);
+    if (num_runs == 0) {
+      fail();
+      return nullptr;
+    }
+    using Run = ConstantSparseArray::Run;
+    auto runs = static_cast<Run *>(m_->allocate(
+        sizeof(Run) * num_runs, alignof(Run), Arena::ConstantKind));
+    std::size_t end = 0;
+    std::size_t stored = 0;
+    for (std::size_t k = 0; k < num_runs && !error_; k++) {
+      std::uint64_t gap = read_varint();
+      std::uint64_t size = read_varint();
+      if (size == 0 || gap > num - end || size > num - end - gap) {
+        fail();
+        return nullptr;
+      }
+      runs[k] = {static_cast<std::size_t>(end + gap),
+                 static_cast<std::size_t>(size), stored};
+      end = runs[k].end();
+      stored += runs[k].size_;
+    }
+    const unsigned char *data = read_aligned(stored * 4);
+    if (data == nullptr) {
+      return nullptr;
+    }
+    const void *buf = data;
+    if (!lazy_) {
+      void *copy = m_->allocate(stored * 4, alignof(unsigned),
+                                Arena::ConstantKind);
+      std::memcpy(copy, data, stored * 4);
+      buf = copy;
+    }
+    c = new (m_, 0) ConstantSparseArray(aty, runs, num_runs, buf, num);
+    break;
+  }
+  default:
+    fail();
+    return nullptr;
+  }
+  return c;
+}
+
+/*!
+ *@brief 读取常量表
+ *@return 是否成功
+ *@note
+ *---------
+ *延迟加载时整数与浮点常量只校验并记录位置，首次被引用时才创建，
+ *只在个别函数体中出现的大量常量不再拖慢加载
+ */
+bool IRReader::read_constants() {
+  std::size_t n = read_index(end_ - cur_ + 1);
+  consts_.reserve(n);
+  if (lazy_) {
+    const_records_.reserve(n + 1);
+  }
+  for (std::size_t i = 0; i < n && !error_; i++) {
+    if (lazy_) {
+      const_records_.push_back(cur_);
+    }
+    consts_.push_back(read_constant(lazy_));
+  }
+  if (lazy_) {
+    const_records_.push_back(cur_);
+  }
+  return !error_;
+}
+
+/*!
+ *@brief 获取常量，延迟加载时首次引用才创建
+ *@param id 常量表序号，须未越界
+ *@return 常量指针
+ *@note 暂未创建的常量按记录位置重新读取，记录已在读取常量表时校验
+ */
+Constant *IRReader::get_constant(unsigned id) {
+  if (consts_[id] == nullptr) {
+    const unsigned char *saved_cur = cur_;
+    const unsigned char *saved_end = end_;
+    cur_ = const_records_[id];
+    end_ = const_records_[id + 1];
+    consts_[id] = read_constant(false);
+    cur_ = saved_cur;
+    end_ = saved_end;
+  }
+  return consts_[id];
+}
+
+/*!
+ *@brief 读取常量序号
+ *@return 常量指针，越界时为空
+ */
+Constant *IRReader::read_constant_ref() {
+  unsigned id = read_index(consts_.size());
+  return error_ ? nullptr : get_constant(id);
+}
+
+/*!
+ *@brief 读取全局量
+ *@return 是否成功
+ *@note 按需构建嵌套初值的全局量读回后同样按需构建
+ */
+bool IRReader::read_globals() {
+  std::size_t n = read_index(end_ - cur_ + 1);
+  for (std::size_t i = 0; i < n && !error_; i++) {
+    std::string_view name = read_name();
+    Type *ty = read_type();
+    unsigned flags = read_index(IRBinaryFormat::FlatInitFlag * 2);
+    if (error_ || !ty->is_pointer_type()) {
+      return fail();
+    }
+    // 打印全局量须有初值
+    if ((flags & IRBinaryFormat::InitFlag) == 0) {
+      return fail();
+    }
+    Constant *init = read_constant_ref();
+    if (error_ || init->get_type() != ty->get_pointer_element_type()) {
+      return fail();
+    }
+    auto gv = GlobalVariable::create(
+        std::string(name), m_, ty->get_pointer_element_type(),
+        (flags & IRBinaryFormat::ConstFlag) != 0, init);
+    if (flags & IRBinaryFormat::LazyInitFlag) {
+      // 只有int32紧凑初值可由扁平存储构建嵌套初值
+      auto data = dyn_cast<ConstantDataArray>(init);
+      if (data == nullptr || !data->get_element_type()->is_int32_type() ||
+          !init->get_type()->is_array_type()) {
+        return fail();
+      }
+      gv->init_val_ = nullptr;
+    }
+    if (flags & IRBinaryFormat::FlatInitFlag) {
+      std::size_t num = read_index(end_ - cur_ + 1);
+      std::vector<int> flat;
+      flat.reserve(num);
+      for (std::size_t k = 0; k < num && !error_; k++) {
+        flat.push_back(static_cast<int>(read_signed()));
+      }
+      // 有int32数组初值时扁平初值替换初值，元素个数须与类型一致
+      auto pointee = ty->get_pointer_element_type();
+      auto aty = pointee->is_array_type() ? static_cast<ArrayType *>(pointee)
+                                          : nullptr;
+      if (error_ || (aty != nullptr && aty->get_scalar_type()->is_int32_type() &&
+           aty->get_num_of_flat_elements() != flat.size())) {
+        return fail();
+      }
+      gv->setFlattenInit(flat);
+    }
+    globals_.push_back(gv);
+  }
+  return !error_;
+}
+
+/*!
+ *@brief 读取函数声明
+ *@return 是否成功
+ *@note 函数体紧随全部声明之后依次存放，此处只记录各函数体的位置
+ */
+bool IRReader::read_functions() {
+  std::size_t n = read_index(end_ - cur_ + 1);
+  std::vector<std::size_t> body_sizes;
+  for (std::size_t i = 0; i < n && !error_; i++) {
+    std::string_view name = read_name();
+    Type *ty = read_type();
+    unsigned seq_cnt = read_index(UINT_MAX);
+    if (error_ || !ty->is_function_type()) {
+      return fail();
+    }
+    auto fty = static_cast<FunctionType *>(ty);
+    auto f = Function::create(fty, std::string(name), m_);
+    f->seq_cnt_ = seq_cnt;
+    for (auto arg : f->get_args()) {
+      std::string_view arg_name = read_name();
+      if (!arg_name.empty()) {
+        arg->set_name(arg_name);
+      }
+    }
+    body_sizes.push_back(read_index(end_ - cur_ + 1));
+    globals_.push_back(f);
+  }
+  if (error_) {
+    return false;
+  }
+  const unsigned char *pos = cur_;
+  for (std::size_t i = 0; i < n; i++) {
+    if (body_sizes[i] == 0) {
+      continue;
+    }
+    if (static_cast<std::size_t>(end_ - pos) < body_sizes[i]) {
+      return fail();
+    }
+    bodies_.push_back(
+        {cast<Function>(globals_[globals_.size() - n + i]), pos,
+         pos + body_sizes[i]});
+    pos += body_sizes[i];
+  }
+  cur_ = pos;
+  return true;
+}
+
+/*!
+ *@brief 校验指令的operand
+ *@param instr 已填入operand的指令
+ *@param f 所属函数
+ *@return 是否合法
+ *@note
+ *---------
+ *operand均不为空，基本块只能作跳转目标与phi的来源，函数只能作被调函数；
+ *再按OpID校验operand与结果的类型，与打印及各指令的构造函数的要求一致
+ */
+bool IRReader::verify_instruction(Instruction *instr, Function *f) {
+  unsigned n = instr->get_num_operand();
+  auto op_type = [instr](unsigned i) {
+    return instr->get_operand(i)->get_type();
+  };
+  for (unsigned i = 0; i < n; i++) {
+    Value *v = instr->get_operand(i);
+    if (v == nullptr) {
+      return false;
+    }
+    bool label_slot = (instr->is_br() && (n == 1 || i != 0)) ||
+                      (instr->is_phi() && i % 2 == 1);
+    bool callee_slot = instr->is_call() && i == 0;
+    if (isa<BasicBlock>(v) != label_slot || isa<Function>(v) != callee_slot) {
+      return false;
+    }
+  }
+  Type *ty = instr->get_type();
+  switch (instr->get_instr_type()) {
+  case Instruction::add:
+  case Instruction::sub:
+  case Instruction::mul:
+  case Instruction::sdiv:
+  case Instruction::mod:
+    return ty->is_integer_type() && op_type(0) == ty && op_type(1) == ty;
+  case Instruction::cmp:
+    return ty->is_int1_type() && op_type(0)->is_integer_type() &&
+           op_type(0) == op_type(1);
+  case Instruction::zext:
+    return ty->is_integer_type() && op_type(0)->is_integer_type();
+  case Instruction::call: {
+    auto callee = static_cast<Function *>(instr->get_operand(0));
+    auto fty = callee->get_function_type();
+    if (fty->get_num_of_args() != n - 1 || ty != fty->get_return_type()) {
+      return false;
+    }
+    for (unsigned i = 1; i < n; i++) {
+      if (op_type(i) != fty->get_param_type(i - 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  case Instruction::br:
+    return n == 1 || op_type(0)->is_int1_type();
+  case Instruction::ret:
+    return n == 0 ? f->get_return_type()->is_void_type()
+                  : op_type(0) == f->get_return_type() &&
+                        is_value_type(op_type(0));
+  case Instruction::getelementptr: {
+    if (!op_type(0)->is_pointer_type()) {
+      return false;
+    }
+    // 第一个下标只偏移指针，其余每个下标进入一层数组
+    Type *elem_ty = op_type(0)->get_pointer_element_type();
+    for (unsigned i = 1; i < n; i++) {
+      if (!op_type(i)->is_integer_type()) {
+        return false;
+      }
+      if (i > 1) {
+        if (!elem_ty->is_array_type()) {
+          return false;
+        }
+        elem_ty = static_cast<ArrayType *>(elem_ty)->get_element_type();
+      }
+    }
+    return is_value_type(elem_ty) &&
+           elem_ty ==
+               static_cast<GetElementPtrInst *>(instr)->get_element_type();
+  }
+  case Instruction::store:
+    return op_type(1)->is_pointer_type() &&
+           op_type(0) == op_type(1)->get_pointer_element_type() &&
+           is_value_type(op_type(0));
+  case Instruction::load:
+    return op_type(0)->is_pointer_type() && is_value_type(ty);
+  case Instruction::alloca:
+    return is_value_type(static_cast<AllocaInst *>(instr)->get_alloca_type());
+  case Instruction::phi: {
+    if (n == 0 || !is_value_type(ty)) {
+      return false;
+    }
+    for (unsigned i = 0; i < n; i += 2) {
+      if (op_type(i) != ty) {
+        return false;
+      }
+    }
+    Value *lval = static_cast<PhiInst *>(instr)->get_lval();
+    return lval == nullptr || lval->get_type()->is_pointer_type();
+  }
+  }
+  return false;
+}
+
+/*!
+ *@brief 读取函数体
+ *@param range 函数与函数体的位置
+ *@return 是否成功
+ *@note
+ *---------
+ *先创建全部基本块，再逐条创建operand槽为空的指令，最后统一填入operand；
+ *跳转指令的基本块operand按各基本块记录的前置基本块顺序挂链，
+ *使前置基本块的顺序与原模块相同
+ */
+bool IRReader::read_function_body(const BodyRange &range) {
+  const unsigned char *saved_end = end_;
+  cur_ = range.begin_;
+  end_ = range.end_;
+  Function *f = range.func_;
+
+  std::size_t num_bbs = read_index(end_ - cur_ + 1);
+  std::vector<BasicBlock *> bbs;
+  std::vector<std::size_t> num_instrs;
+  std::size_t total_instrs = 0;
+  for (std::size_t i = 0; i < num_bbs && !error_; i++) {
+    std::string_view name = read_name();
+    bool fake = read_index(2) != 0;
+    num_instrs.push_back(read_index(end_ - cur_ + 1));
+    total_instrs += num_instrs.back();
+    auto bb = BasicBlock::create(m_, "", f, fake);
+    if (!name.empty()) {
+      bb->set_name(name);
+    }
+    bbs.push_back(bb);
+  }
+  std::vector<std::vector<unsigned>> preds(bbs.size());
+  for (std::size_t i = 0; i < bbs.size() && !error_; i++) {
+    std::size_t num_preds = read_index(end_ - cur_ + 1);
+    for (std::size_t k = 0; k < num_preds && !error_; k++) {
+      preds[i].push_back(read_index(bbs.size()));
+    }
+  }
+
+  const std::size_t arg_base = globals_.size() + consts_.size();
+  const std::size_t bb_base = arg_base + f->get_num_of_args();
+  const std::size_t instr_base = bb_base + bbs.size();
+  std::vector<Argument *> args(f->get_args().begin(), f->get_args().end());
+  std::vector<Instruction *> instrs;
+  instrs.reserve(total_instrs);
+
+  /*! 待填入的operand，id为value编号，空operand为-1*/
+  struct PendingOp {
+    Instruction *instr_;
+    std::size_t block_;
+    unsigned index_;
+    std::int64_t id_;
+  };
+  std::vector<PendingOp> ops;
+  std::vector<std::pair<PhiInst *, std::int64_t>> lvals;
+  auto read_operand = [&](std::size_t cur) -> std::int64_t {
+    std::uint64_t enc = read_varint();
+    if (enc == 0) {
+      return -1;
+    }
+    enc--;
+    std::int64_t rel =
+        static_cast<std::int64_t>(enc >> 1) ^ -static_cast<std::int64_t>(enc & 1);
+    std::int64_t id = static_cast<std::int64_t>(cur) - rel;
+    if (id < 0 || id >= static_cast<std::int64_t>(instr_base + total_instrs)) {
+      fail();
+      return -1;
+    }
+    return id;
+  };
+
+  for (std::size_t b = 0; b < bbs.size() && !error_; b++) {
+    BasicBlock *bb = bbs[b];
+    for (std::size_t k = 0; k < num_instrs[b] && !error_; k++) {
+      std::size_t cur = instr_base + instrs.size();
+      auto op = static_cast<Instruction::OpID>(
+          read_index(Instruction::zext + 1));
+      Type *ty = read_type();
+      std::string_view name = read_name();
+      unsigned num_ops = read_index(end_ - cur_ + 1);
+      std::size_t first_op = ops.size();
+      for (unsigned i = 0; i < num_ops && !error_; i++) {
+        ops.push_back({nullptr, b, i, read_operand(cur)});
+      }
+      if (error_) {
+        break;
+      }
+      Instruction *instr = nullptr;
+      switch (op) {
+      case Instruction::add:
+      case Instruction::sub:
+      case Instruction::mul:
+      case Instruction::sdiv:
+      case Instruction::mod:
+        if (num_ops == 2) {
+          instr = new (bb, 2) BinaryInst(ty, op, bb);
+        }
+        break;
+      case Instruction::cmp: {
+        auto cmp_op = static_cast<CmpInst::CmpOp>(read_index(CmpInst::LE + 1));
+        if (num_ops == 2 && !error_) {
+          instr = new (bb, 2) CmpInst(ty, cmp_op, bb);
+        }
+        break;
+      }
+      case Instruction::call:
+        if (num_ops >= 1) {
+          instr = new (bb, User::hung_off) CallInst(ty, num_ops, bb);
+        }
+        break;
+      case Instruction::br:
+        if (num_ops == 1 || num_ops == 3) {
+          instr = new (bb, num_ops) BranchInst(num_ops, bb);
+        }
+        break;
+      case Instruction::ret:
+        if (num_ops <= 1) {
+          instr = new (bb, num_ops) ReturnInst(bb, num_ops);
+        }
+        break;
+      case Instruction::getelementptr: {
+        Type *elem_ty = read_type();
+        if (num_ops >= 1 && !error_) {
+          instr = new (bb, num_ops) GetElementPtrInst(elem_ty, num_ops, bb);
+        }
+        break;
+      }
+      case Instruction::store:
+        if (num_ops == 2) {
+          instr = new (bb, 2) StoreInst(bb);
+        }
+        break;
+      case Instruction::load:
+        if (num_ops == 1) {
+          instr = new (bb, 1) LoadInst(ty, bb);
+        }
+        break;
+      case Instruction::alloca: {
+        Type *alloca_ty = read_type();
+        bool init = read_index(2) != 0;
+        if (num_ops == 0 && !error_) {
+          auto alloca = new (bb, 0) AllocaInst(alloca_ty, bb);
+          if (init) {
+            alloca->set_init();
+          }
+          instr = alloca;
+        }
+        break;
+      }
+      case Instruction::zext:
+        if (num_ops == 1) {
+          instr = new (bb, 1) ZextInst(ty, bb);
+        }
+        break;
+      case Instruction::phi: {
+        std::int64_t lval = read_operand(cur);
+        if (num_ops % 2 == 0 && !error_) {
+          auto phi = new (bb, User::hung_off) PhiInst(ty, num_ops, bb);
+          lvals.emplace_back(phi, lval);
+          instr = phi;
+        }
+        break;
+      }
+      }
+      if (instr == nullptr) {
+        fail();
+        break;
+      }
+      if (!name.empty()) {
+        instr->set_name(name);
+      }
+      for (std::size_t i = first_op; i < ops.size(); i++) {
+        ops[i].instr_ = instr;
+      }
+      instrs.push_back(instr);
+    }
+  }
+  if (error_ || cur_ != end_) {
+    end_ = saved_end;
+    return fail();
+  }
+  end_ = saved_end;
+
+  auto lookup = [&](std::int64_t id) -> Value * {
+    if (id < 0) {
+      return nullptr;
+    }
+    std::size_t i = static_cast<std::size_t>(id);
+    if (i < globals_.size()) {
+      return globals_[i];
+    }
+    if (i < arg_base) {
+      return get_constant(static_cast<unsigned>(i - globals_.size()));
+    }
+    if (i < bb_base) {
+      return args[i - arg_base];
+    }
+    if (i < instr_base) {
+      return bbs[i - bb_base];
+    }
+    return instrs[i - instr_base];
+  };
+
+  // 跳转目标按所在基本块暂存，其余operand直接填入
+  std::vector<std::vector<PendingOp>> targets(bbs.size());
+  for (auto &op : ops) {
+    Value *v = lookup(op.id_);
+    if (auto br = dyn_cast<BranchInst>(op.instr_)) {
+      bool is_target = br->get_num_operand() == 1 || op.index_ != 0;
+      if (is_target != (v != nullptr && isa<BasicBlock>(v))) {
+        return fail();
+      }
+      if (is_target) {
+        targets[op.block_].push_back(op);
+        continue;
+      }
+    } else if (isa<CallInst>(op.instr_) && op.index_ == 0 &&
+               (v == nullptr || !isa<Function>(v))) {
+      return fail();
+    }
+    op.instr_->set_operand(op.index_, v);
+  }
+  for (auto &entry : lvals) {
+    entry.first->set_lval(lookup(entry.second));
+  }
+  for (std::size_t b = 0; b < bbs.size(); b++) {
+    for (unsigned pred : preds[b]) {
+      auto &pending = targets[pred];
+      auto it = std::find_if(pending.begin(), pending.end(),
+                             [&](const PendingOp &op) {
+                               return lookup(op.id_) == bbs[b];
+                             });
+      if (it == pending.end()) {
+        return fail();
+      }
+      it->instr_->set_operand(it->index_, bbs[b]);
+      pending.erase(it);
+    }
+  }
+  for (auto &pending : targets) {
+    if (!pending.empty()) {
+      return fail();
+    }
+  }
+  for (auto instr : instrs) {
+    if (!verify_instruction(instr, f)) {
+      return fail();
+    }
+  }
+  return true;
+}
+
+/*!
+ *@brief 创建模块并读取函数体之外的各表
+ *@param name 模块名称
+ *@return 是否成功，失败时模块已析构
+ *@note 读取后输入须恰好读完，函数体的位置记录在bodies_中
+ */
+bool IRReader::read_declarations(const std::string &name) {
+  m_ = new Module(name);
+  bool ok = read_header() && read_strings() && read_types() &&
+            read_constants() && read_globals() && read_functions();
+  if (!ok || cur_ != end_) {
+    error_ = true;
+    delete m_;
+    m_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+/*!
+ *@brief 读取模块
+ *@param name 模块名称
+ *@return 新建的模块，格式错误时为空
+ *@note 读取失败时已创建的部分随模块一起析构
+ */
+Module *IRReader::read_module(const std::string &name) {
+  if (!read_declarations(name)) {
+    return nullptr;
+  }
+  bool ok = true;
+  for (std::size_t i = 0; ok && i < bodies_.size(); i++) {
+    ok = read_function_body(bodies_[i]);
+  }
+  Module *m = m_;
+  m_ = nullptr;
+  if (!ok) {
+    delete m;
+    return nullptr;
+  }
+  return m;
+}
+
+/*!
+ *@brief 读取延迟加载的函数体
+ *@param f 函数体尚未读取的函数
+ *@return 是否成功，失败时函数保持为声明
+ *@note
+ *---------
+ *各函数体相互独立，之前的格式错误不影响本次读取；
+ *读取失败时摘除已创建指令的operand，使全局量与常量的use链不含残缺的函数体，
+ *已创建的对象随模块析构
+ */
+bool IRReader::materialize(Function *f) {
+  auto it = pending_.find(f);
+  if (it == pending_.end()) {
+    return false;
+  }
+  BodyRange range = it->second;
+  pending_.erase(it);
+  bool had_error = error_;
+  error_ = false;
+  bool ok = read_function_body(range);
+  error_ = had_error || !ok;
+  if (!ok) {
+    for (auto bb : f->basic_blocks_) {
+      for (auto instr : bb->get_instructions()) {
+        instr->remove_use_of_ops();
+      }
+    }
+    f->basic_blocks_.clear();
+    f->invalidate_numbering();
+  }
+  return ok;
+}
+
+/*!
+ *@brief 从字节串读取模块
+ *@param data 二进制中间代码
+ *@param name 模块名称
+ *@return 新建的模块，格式错误时为空
+ */
+Module *IRReader::read(std::string_view data, const std::string &name) {
+  return IRReader(data.data(), data.size()).read_module(name);
+}
+
+/*!
+ *@brief 从文件读取模块
+ *@param path 文件路径
+ *@param name 模块名称
+ *@return 新建的模块，打开失败或格式错误时为空
+ */
+Module *IRReader::read_file(const std::string &path, const std::string &name) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return nullptr;
+  }
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  return read(data, name);
+}
+
+/*!
+ *@brief 映射文件并延迟加载模块
+ *@param path 文件路径
+ *@param name 模块名称
+ *@return 新建的模块，打开、映射失败或格式错误时为空
+ *@note 映射后即可关闭文件；读取器随映射一起交给模块，函数体标记为待读取
+ */
+Module *IRReader::load_file(const std::string &path, const std::string &name) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ,
+                  MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+
+  auto materializer = std::make_unique<MappedMaterializer>(
+      data, static_cast<std::size_t>(st.st_size));
+  IRReader &reader = materializer->get_reader();
+  reader.lazy_ = true;
+  if (!reader.read_declarations(name)) {
+    return nullptr;
+  }
+  for (auto &range : reader.bodies_) {
+    range.func_->materializable_ = true;
+    reader.pending_.emplace(range.func_, range);
+  }
+  reader.bodies_.clear();
+  Module *m = reader.m_;
+  m->set_materializer(std::move(materializer));
+  return m;
+}
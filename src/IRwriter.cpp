@@ -0,0 +1,448 @@
+/*!
+ *@file IRwriter.cpp
+ *@brief 二进制中间代码写出器接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#include "IRbinary.h"
+
+#include <cstring>
+
+namespace {
+/*!
+ *@brief 追加LEB128变长编码的无符号数
+ *@param out 目标字节串
+ *@param v 数值
+ */
+void put_varint(std::string &out, std::uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+/*!
+ *@brief 追加zigzag变换后的有符号数
+ *@param out 目标字节串
+ *@param v 数值
+ *@note 绝对值小的负数同样只占一个字节
+ */
+void put_signed(std::string &out, std::int64_t v) {
+  put_varint(out, (static_cast<std::uint64_t>(v) << 1) ^
+                      static_cast<std::uint64_t>(v >> 63));
+}
+
+/*!
+ *@brief 按4字节对齐追加原始字节
+ *@param out 目标字节串，起点即文件起点
+ *@param data 数据
+ *@param bytes 字节数
+ *@note 元素按本机字节序存放，格式约定为小端
+ */
+void put_aligned(std::string &out, const void *data, std::size_t bytes) {
+  out.append((4 - out.size() % 4) % 4, '\0');
+  out.append(static_cast<const char *>(data), bytes);
+}
+} // namespace
+
+/*!
+ *@brief 登记名称
+ *@param v value指针
+ */
+void IRWriter::add_name(Value *v) {
+  if (!v->has_name()) {
+    return;
+  }
+  if (string_ids_.emplace(v->get_name(), strings_.size()).second) {
+    strings_.push_back(v->get_name());
+  }
+}
+
+/*!
+ *@brief 登记类型及其组成类型
+ *@param ty 类型指针
+ *@note 组成类型先于自身登记，读取时按序创建即可
+ */
+void IRWriter::add_type(Type *ty) {
+  if (type_ids_.count(ty) != 0) {
+    return;
+  }
+  switch (ty->get_type_id()) {
+  case Type::FunctionTyID: {
+    auto fty = static_cast<FunctionType *>(ty);
+    add_type(fty->get_return_type());
+    for (unsigned i = 0; i < fty->get_num_of_args(); i++) {
+      add_type(fty->get_param_type(i));
+    }
+    break;
+  }
+  case Type::ArrayTyID:
+    add_type(static_cast<ArrayType *>(ty)->get_element_type());
+    break;
+  case Type::PointerTyID:
+    add_type(ty->get_pointer_element_type());
+    break;
+  default:
+    break;
+  }
+  type_ids_.emplace(ty, types_.size());
+  types_.push_back(ty);
+}
+
+/*!
+ *@brief 登记常量及其元素
+ *@param c 常量指针
+ *@note 常量数组的元素先于自身登记
+ */
+void IRWriter::add_constant(Constant *c) {
+  if (const_ids_.count(c) != 0) {
+    return;
+  }
+  add_type(c->get_type());
+  if (auto arr = dyn_cast<ConstantArray>(c)) {
+    for (unsigned i = 0; i < arr->get_size_of_array(); i++) {
+      add_constant(arr->get_element_value(i));
+    }
+  }
+  const_ids_.emplace(c, consts_.size());
+  consts_.push_back(c);
+}
+
+/*!
+ *@brief 登记函数体中的类型、常量与名称
+ *@param f 函数指针
+ */
+void IRWriter::add_function_body(Function *f) {
+  for (auto bb : f->get_basic_blocks()) {
+    add_name(bb);
+    for (auto instr : bb->get_instructions()) {
+      add_name(instr);
+      add_type(instr->get_type());
+      for (unsigned i = 0; i < instr->get_num_operand(); i++) {
+        if (auto c = dyn_cast_or_null<Constant>(instr->get_operand(i))) {
+          add_constant(c);
+        }
+      }
+      if (auto alloca = dyn_cast<AllocaInst>(instr)) {
+        add_type(alloca->get_alloca_type());
+      } else if (auto gep = dyn_cast<GetElementPtrInst>(instr)) {
+        add_type(gep->get_element_type());
+      } else if (auto phi = dyn_cast<PhiInst>(instr)) {
+        if (auto c = dyn_cast_or_null<Constant>(phi->get_lval())) {
+          add_constant(c);
+        }
+      }
+    }
+  }
+}
+
+/*!
+ *@brief 获取名称的引用
+ *@param v value指针
+ *@return 字符串表序号加1，无名称时为0
+ */
+unsigned IRWriter::get_name_ref(Value *v) const {
+  return v->has_name() ? string_ids_.at(v->get_name()) + 1 : 0;
+}
+
+/*!
+ *@brief 写出类型表
+ *@param out 目标字节串
+ *@note 每项为TypeID及组成类型的序号
+ */
+void IRWriter::write_types(std::string &out) const {
+  put_varint(out, types_.size());
+  for (auto ty : types_) {
+    put_varint(out, ty->get_type_id());
+    switch (ty->get_type_id()) {
+    case Type::FunctionTyID: {
+      auto fty = static_cast<FunctionType *>(ty);
+      put_varint(out, get_type_id(fty->get_return_type()));
+      put_varint(out, fty->get_num_of_args());
+      for (unsigned i = 0; i < fty->get_num_of_args(); i++) {
+        put_varint(out, get_type_id(fty->get_param_type(i)));
+      }
+      break;
+    }
+    case Type::ArrayTyID: {
+      auto aty = static_cast<ArrayType *>(ty);
+      put_varint(out, get_type_id(aty->get_element_type()));
+      put_varint(out, aty->get_num_of_elements());
+      break;
+    }
+    case Type::PointerTyID:
+      put_varint(out, get_type_id(ty->get_pointer_element_type()));
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/*!
+ *@brief 写出常量表
+ *@param out 目标字节串
+ *@note 每项为种类、类型序号及内容，紧凑与稀疏数组的元素按4字节原样存放
+ */
+void IRWriter::write_constants(std::string &out) const {
+  put_varint(out, consts_.size());
+  for (auto c : consts_) {
+    if (auto ci = dyn_cast<ConstantInt>(c)) {
+      put_varint(out, IRBinaryFormat::IntTag);
+      put_varint(out, get_type_id(c->get_type()));
+      put_signed(out, ci->get_value());
+    } else if (auto cf = dyn_cast<ConstantFP>(c)) {
+      float val = cf->get_value();
+      std::uint32_t bits;
+      std::memcpy(&bits, &val, sizeof(bits));
+      put_varint(out, IRBinaryFormat::FPTag);
+      put_varint(out, get_type_id(c->get_type()));
+      put_varint(out, bits);
+    } else if (isa<ConstantZero>(c)) {
+      put_varint(out, IRBinaryFormat::ZeroTag);
+      put_varint(out, get_type_id(c->get_type()));
+    } else if (auto arr = dyn_cast<ConstantArray>(c)) {
+      put_varint(out, IRBinaryFormat::ArrayTag);
+      put_varint(out, get_type_id(c->get_type()));
+      put_varint(out, arr->get_size_of_array());
+      for (unsigned i = 0; i < arr->get_size_of_array(); i++) {
+        put_varint(out, const_ids_.at(arr->get_element_value(i)));
+      }
+    } else if (auto data = dyn_cast<ConstantDataArray>(c)) {
+      put_varint(out, IRBinaryFormat::DataArrayTag);
+      put_varint(out, get_type_id(c->get_type()));
+      put_varint(out, data->get_num_elements());
+      const void *elems = data->get_element_type()->is_float_type()
+                              ? static_cast<const void *>(data->get_float_data())
+                              : data->get_int_data();
+      put_aligned(out, elems, data->get_num_elements() * 4);
+    } else {
+      auto sparse = cast<ConstantSparseArray>(c);
+      put_varint(out, IRBinaryFormat::SparseArrayTag);
+      put_varint(out, get_type_id(c->get_type()));
+      put_varint(out, sparse->get_num_elements());
+      put_varint(out, sparse->get_num_runs());
+      std::size_t prev_end = 0;
+      std::size_t stored = 0;
+      for (unsigned i = 0; i < sparse->get_num_runs(); i++) {
+        auto &run = sparse->get_run(i);
+        put_varint(out, run.begin_ - prev_end);
+        put_varint(out, run.size_);
+        prev_end = run.end();
+        stored += run.size_;
+      }
+      // 各区间的元素在存储中依次相接，自第一个区间起整体写出
+      auto &first = sparse->get_run(0);
+      put_aligned(out, sparse->get_run_ints(first), stored * 4);
+    }
+  }
+}
+
+/*!
+ *@brief 写出全局量
+ *@param out 目标字节串
+ *@note 每项为名称、类型、标志及初值常量的序号，按需附带扁平初值
+ */
+void IRWriter::write_globals(std::string &out) {
+  put_varint(out, m_->get_global_variable().size());
+  for (auto gv : m_->get_global_variable()) {
+    unsigned flags = gv->is_const() ? IRBinaryFormat::ConstFlag : 0;
+    Constant *init = nullptr;
+    if (gv->get_num_operand() != 0) {
+      init = cast<Constant>(gv->get_operand(0));
+      flags |= IRBinaryFormat::InitFlag;
+      // 已由扁平存储构建的嵌套初值只是缓存，读回时同样按需构建
+      if (gv->init_val_ != init && isa<ConstantDataArray>(init)) {
+        flags |= IRBinaryFormat::LazyInitFlag;
+      }
+    }
+    // 扁平存储即紧凑初值的元素或由稀疏初值展开时不必另存
+    auto data = dyn_cast_or_null<ConstantDataArray>(init);
+    bool derived = (data != nullptr && data->get_element_type()->is_int32_type() &&
+                    data->get_int_data() == gv->flat_data_) ||
+                   (init != nullptr && isa<ConstantSparseArray>(init));
+    if (gv->flat_data_ != nullptr && !derived) {
+      flags |= IRBinaryFormat::FlatInitFlag;
+    }
+    put_varint(out, get_name_ref(gv));
+    put_varint(out, get_type_id(gv->get_type()));
+    put_varint(out, flags);
+    if (init != nullptr) {
+      put_varint(out, const_ids_.at(init));
+    }
+    if (flags & IRBinaryFormat::FlatInitFlag) {
+      put_varint(out, gv->flat_size_);
+      for (std::size_t i = 0; i < gv->flat_size_; i++) {
+        put_signed(out, gv->flat_data_[i]);
+      }
+    }
+  }
+}
+
+/*!
+ *@brief 写出函数体
+ *@param out 目标字节串
+ *@param f 函数指针，须有基本块
+ *@note
+ *---------
+ *先写各基本块的名称、标志与指令数，再写各基本块的前置基本块，
+ *最后逐条写指令：OpID、类型、名称、operand个数、各operand及附加字段；
+ *operand为0表示空，否则为zigzag(当前指令序号-operand序号)+1
+ */
+void IRWriter::write_function_body(std::string &out, Function *f) {
+  f->compute_numbering();
+  const std::size_t module_values =
+      global_ids_.size() + consts_.size();
+  const std::size_t arg_base = module_values;
+  const std::size_t bb_base = arg_base + f->get_num_of_args();
+  const std::size_t instr_base = bb_base + f->get_num_numbered_blocks();
+
+  auto value_id = [&](Value *v) -> std::size_t {
+    if (auto instr = dyn_cast<Instruction>(v)) {
+      assert(instr->get_function() == f && "operand from another function");
+      return instr_base + instr->get_number();
+    }
+    if (auto bb = dyn_cast<BasicBlock>(v)) {
+      assert(bb->get_parent() == f && "operand from another function");
+      return bb_base + bb->get_number();
+    }
+    if (auto arg = dyn_cast<Argument>(v)) {
+      assert(arg->get_parent() == f && "operand from another function");
+      return arg_base + arg->get_arg_no();
+    }
+    if (auto c = dyn_cast<Constant>(v)) {
+      return global_ids_.size() + const_ids_.at(c);
+    }
+    return global_ids_.at(v);
+  };
+  auto put_operand = [&](std::size_t cur, Value *v) {
+    if (v == nullptr) {
+      put_varint(out, 0);
+      return;
+    }
+    std::int64_t rel = static_cast<std::int64_t>(cur) -
+                       static_cast<std::int64_t>(value_id(v));
+    put_varint(out, ((static_cast<std::uint64_t>(rel) << 1) ^
+                     static_cast<std::uint64_t>(rel >> 63)) +
+                        1);
+  };
+
+  auto &bbs = f->get_basic_blocks();
+  put_varint(out, bbs.size());
+  for (auto bb : bbs) {
+    put_varint(out, get_name_ref(bb));
+    put_varint(out, bb->is_fake_block());
+    put_varint(out, bb->get_instructions().size());
+  }
+  for (auto bb : bbs) {
+    auto &preds = bb->get_pre_basic_blocks();
+    put_varint(out, preds.size());
+    for (auto pred : preds) {
+      put_varint(out, pred->get_number());
+    }
+  }
+  for (auto bb : bbs) {
+    for (auto instr : bb->get_instructions()) {
+      std::size_t cur = instr_base + instr->get_number();
+      put_varint(out, instr->get_instr_type());
+      put_varint(out, get_type_id(instr->get_type()));
+      put_varint(out, get_name_ref(instr));
+      put_varint(out, instr->get_num_operand());
+      for (unsigned i = 0; i < instr->get_num_operand(); i++) {
+        put_operand(cur, instr->get_operand(i));
+      }
+      switch (instr->get_instr_type()) {
+      case Instruction::cmp:
+        put_varint(out, static_cast<CmpInst *>(instr)->get_cmp_op());
+        break;
+      case Instruction::alloca: {
+        auto alloca = static_cast<AllocaInst *>(instr);
+        put_varint(out, get_type_id(alloca->get_alloca_type()));
+        put_varint(out, alloca->get_init());
+        break;
+      }
+      case Instruction::getelementptr:
+        put_varint(out, get_type_id(
+                            static_cast<GetElementPtrInst *>(instr)
+                                ->get_element_type()));
+        break;
+      case Instruction::phi:
+        put_operand(cur, static_cast<PhiInst *>(instr)->get_lval());
+        break;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+/*!
+ *@brief 将模块写出到输出流
+ *@param os 输出流
+ *@note 函数体先写入独立的字节串以得到长度，再随函数声明之后写出
+ */
+void IRWriter::write(OutStream &os) {
+  for (auto gv : m_->get_global_variable()) {
+    add_name(gv);
+    add_type(gv->get_type());
+    if (gv->get_num_operand() != 0) {
+      add_constant(cast<Constant>(gv->get_operand(0)));
+    }
+    global_ids_.emplace(gv, global_ids_.size());
+  }
+  for (auto f : m_->get_functions()) {
+    add_name(f);
+    add_type(f->get_type());
+    for (auto arg : f->get_args()) {
+      add_name(arg);
+    }
+    add_function_body(f);
+    global_ids_.emplace(f, global_ids_.size());
+  }
+
+  std::string out(IRBinaryFormat::Magic, sizeof(IRBinaryFormat::Magic));
+  put_varint(out, IRBinaryFormat::Version);
+  put_varint(out, strings_.size());
+  for (auto str : strings_) {
+    put_varint(out, str.size());
+    out.append(str.data(), str.size());
+  }
+  write_types(out);
+  write_constants(out);
+  write_globals(out);
+
+  std::string bodies;
+  auto funcs = m_->get_functions();
+  put_varint(out, funcs.size());
+  for (auto f : funcs) {
+    std::size_t body_begin = bodies.size();
+    if (!f->is_declaration()) {
+      write_function_body(bodies, f);
+    }
+    put_varint(out, get_name_ref(f));
+    put_varint(out, get_type_id(f->get_type()));
+    put_varint(out, f->seq_cnt_);
+    for (auto arg : f->get_args()) {
+      put_varint(out, get_name_ref(arg));
+    }
+    put_varint(out, bodies.size() - body_begin);
+  }
+  os.write(out.data(), out.size());
+  os.write(bodies.data(), bodies.size());
+}
+
+/*!
+ *@brief 将模块写出为字节串
+ *@param m 模块
+ *@return 二进制中间代码
+ */
+std::string IRWriter::write(Module *m) {
+  std::string out;
+  {
+    StringOutStream os(out);
+    IRWriter(m).write(os);
+  }
+  return out;
+}
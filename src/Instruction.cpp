@@ -13,20 +13,143 @@
 #include "Constant.h"
 #include "IRprinter.h"
 #include <cassert>
+#include <climits>
 #include <vector>
 #include <algorithm>
 
 Instruction::Instruction(Type *ty, OpID id, unsigned num_ops,
                         BasicBlock *parent)
-    : User(ty, "", num_ops),parent_(parent), op_id_(id), num_ops_(num_ops)
+    : User(ty, Value::InstructionVal + id, "", num_ops, is_hung_off_op(id)),parent_(parent), op_id_(id)
 {
     parent_->add_instruction(this);
 }
 
 Instruction::Instruction(Type *ty, OpID id, unsigned num_ops)
-    : User(ty, "", num_ops),parent_(nullptr),op_id_(id), num_ops_(num_ops) 
+    : User(ty, Value::InstructionVal + id, "", num_ops, is_hung_off_op(id)),parent_(nullptr),op_id_(id)
+{
+
+}
+
+void *Instruction::operator new(std::size_t size, BasicBlock *bb,
+                               unsigned num_ops)
+{
+    std::size_t prefix = sizeof(Use) * num_ops;
+    char *mem = static_cast<char *>(
+        bb->get_parent()->allocate_instruction(prefix + size));
+    return mem + prefix;
+}
+
+void *Instruction::operator new(std::size_t size, BasicBlock *bb, HungOffTag)
+{
+    char *mem = static_cast<char *>(
+        bb->get_parent()->allocate_instruction(sizeof(Use *) + size));
+    return mem + sizeof(Use *);
+}
+
+std::size_t Instruction::get_object_size() const
+{
+    switch (op_id_) {
+    case ret:
+        return sizeof(ReturnInst);
+    case br:
+        return sizeof(BranchInst);
+    case add:
+    case sub:
+    case mul:
+    case sdiv:
+    case mod:
+        return sizeof(BinaryInst);
+    case alloca:
+        return sizeof(AllocaInst);
+    case load:
+        return sizeof(LoadInst);
+    case store:
+        return sizeof(StoreInst);
+    case cmp:
+        return sizeof(CmpInst);
+    case phi:
+        return sizeof(PhiInst);
+    case call:
+        return sizeof(CallInst);
+    case getelementptr:
+        return sizeof(GetElementPtrInst);
+    case zext:
+        return sizeof(ZextInst);
+    default:
+        assert(0 && "Invalid instr type");
+    }
+    return 0;
+}
+
+void Instruction::erase_from_parent()
+{
+    Function *func = get_function();
+    // 摘出指令链表并删除operand的use
+    parent_->delete_instr(this);
+    assert(use_list_.empty() && "erasing an instruction that still has uses");
+    // 析构前记下对象和独立operand槽所在的内存
+    std::size_t prefix = get_operand_prefix_size();
+    char *mem = reinterpret_cast<char *>(this) - prefix;
+    std::size_t size = prefix + get_object_size();
+    Use *ops = get_hung_off_operands();
+    std::size_t ops_size = sizeof(Use) * get_reserved_operands();
+    this->~Instruction();
+    func->free_instruction(mem, size);
+    if (ops != nullptr && ops_size != 0) {
+        func->free_instruction(ops, ops_size);
+    }
+}
+
+void Instruction::set_parent(BasicBlock *parent)
+{
+    if (parent == parent_)
+        return;
+    // 跳转指令的边由所在基本块发出，换块时逐个目标迁移前置基本块
+    if (is_br())
+    {
+        for (unsigned i = 0; i < get_num_operand(); i++)
+        {
+            Use &use = get_operand_use(i);
+            if (!use.is_linked() || !use.uses_block())
+                continue;
+            auto target = cast<BasicBlock>(use.get());
+            if (parent_ != nullptr)
+                target->remove_pre_basic_block(parent_);
+            if (parent != nullptr)
+                target->add_pre_basic_block(parent);
+        }
+    }
+    parent_ = parent;
+}
+
+void Instruction::move_before(Instruction *pos)
+{
+    get_function()->invalidate_numbering();
+    parent_->get_instructions().remove(this);
+    set_parent(pos->get_parent());
+    parent_->get_instructions().insert_before(pos, this);
+}
+
+void Instruction::move_after(Instruction *pos)
 {
+    get_function()->invalidate_numbering();
+    parent_->get_instructions().remove(this);
+    set_parent(pos->get_parent());
+    parent_->get_instructions().insert_after(pos, this);
+}
 
+bool Instruction::comes_before(const Instruction *other) const
+{
+    assert(parent_ == other->parent_ && "instructions in different blocks");
+    return parent_->get_instructions().comes_before(
+        const_cast<Instruction *>(this), const_cast<Instruction *>(other));
+}
+
+unsigned Instruction::get_number() const
+{
+    assert(parent_ && parent_->get_parent()->has_numbering() &&
+           "function numbering is stale");
+    return number_;
 }
 
 Function *Instruction::get_function()
@@ -62,78 +185,90 @@ void BinaryInst::assertValid()
 
 BinaryInst *BinaryInst::create_add(Value *v1, Value *v2, BasicBlock *bb, Module *m)
 {
-    return new BinaryInst(Type::get_int32_type(m), Instruction::add, v1, v2, bb);
+    return new (bb, 2) BinaryInst(Type::get_int32_type(m), Instruction::add, v1, v2, bb);
 }
 
 BinaryInst *BinaryInst::create_sub(Value *v1, Value *v2, BasicBlock *bb, Module *m)
 {
-    return new BinaryInst(Type::get_int32_type(m), Instruction::sub, v1, v2, bb);
+    return new (bb, 2) BinaryInst(Type::get_int32_type(m), Instruction::sub, v1, v2, bb);
 }
 
 BinaryInst *BinaryInst::create_mul(Value *v1, Value *v2, BasicBlock *bb, Module *m)
 {
-    return new BinaryInst(Type::get_int32_type(m), Instruction::mul, v1, v2, bb);
+    return new (bb, 2) BinaryInst(Type::get_int32_type(m), Instruction::mul, v1, v2, bb);
 }
 
 BinaryInst *BinaryInst::create_sdiv(Value *v1, Value *v2, BasicBlock *bb, Module *m)
 {
-    return new BinaryInst(Type::get_int32_type(m), Instruction::sdiv, v1, v2, bb);
+    return new (bb, 2) BinaryInst(Type::get_int32_type(m), Instruction::sdiv, v1, v2, bb);
 }
 
 BinaryInst *BinaryInst::create_mod(Value *v1, Value *v2, BasicBlock *bb, Module *m)
 {
-    return new BinaryInst(Type::get_int32_type(m), Instruction::mod, v1, v2, bb);
+    return new (bb, 2) BinaryInst(Type::get_int32_type(m), Instruction::mod, v1, v2, bb);
 }
 
 bool BinaryInst::isStaticCalculable() {
-    auto cl = dynamic_cast<ConstantInt *>(get_operand(0));
-    auto cr = dynamic_cast<ConstantInt *>(get_operand(1));
-    return cl != nullptr && cr != nullptr;
+    return isa<ConstantInt>(get_operand(0)) && isa<ConstantInt>(get_operand(1));
 }
 
-std::string BinaryInst::print()
+void BinaryInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += ", ";
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << this->get_operand(0)->get_type()->print();
+    os << " ";
+    print_as_op(os, this->get_operand(0), false);
+    os << ", ";
     if (Type::is_eq_type(this->get_operand(0)->get_type(), this->get_operand(1)->get_type()))
     {
-        instr_ir += print_as_op(this->get_operand(1), false);
+        print_as_op(os, this->get_operand(1), false);
     }
     else
     {
-        instr_ir += print_as_op(this->get_operand(1), true);
+        print_as_op(os, this->get_operand(1), true);
     }
-    return instr_ir;
 }
 
 int BinaryInst::calculate() {
     assert(isStaticCalculable() && "Only static op can be calculated");
-    auto cl = dynamic_cast<ConstantInt *>(get_operand(0))->get_value();
-    auto cr = dynamic_cast<ConstantInt *>(get_operand(1))->get_value();
-    switch (get_instr_type()) {
+    auto cl = cast<ConstantInt>(get_operand(0))->get_value();
+    auto cr = cast<ConstantInt>(get_operand(1))->get_value();
+    return calculate(get_instr_type(), cl, cr);
+}
+
+int BinaryInst::calculate(OpID op, int cl, int cr)
+{
+    // 加减乘按32位补码回绕，避免有符号溢出
+    switch (op) {
         case add:
-            return cl + cr;
+            return (int)((unsigned)cl + (unsigned)cr);
         case sub:
-            return cl - cr;
+            return (int)((unsigned)cl - (unsigned)cr);
         case mul:
-            return cl * cr;
+            return (int)((unsigned)cl * (unsigned)cr);
         case sdiv:
-            if (cr == 0) return 0;
+            if (cr == 0 || (cl == INT_MIN && cr == -1)) return 0;
             return cl / cr;
         case mod:
-            if (cr == 0) return 0;
+            if (cr == 0 || (cl == INT_MIN && cr == -1)) return 0;
             return cl % cr;
         default:
             assert(0 && "Invalid instr type");
     }
+    return 0;
+}
+
+bool BinaryInst::is_foldable(OpID op, int cr)
+{
+    // 除数为0或-1时运行期结果未定义或可能溢出，保留指令
+    if (op == sdiv || op == mod) {
+        return cr != 0 && cr != -1;
+    }
+    return op == add || op == sub || op == mul;
 }
 
 /*
@@ -181,45 +316,46 @@ void CmpInst::assertValid()
 CmpInst *CmpInst::create_cmp(CmpOp op, Value *lhs, Value *rhs, 
                         BasicBlock *bb, Module *m)
 {
-    return new CmpInst(m->get_int1_type(), op, lhs, rhs, bb);
+    return new (bb, 2) CmpInst(m->get_int1_type(), op, lhs, rhs, bb);
 }
 
-std::string CmpInst::print()
+void CmpInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += print_cmp_type(this->cmp_op_);
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += ", ";
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << print_cmp_type(this->cmp_op_);
+    os << " ";
+    os << this->get_operand(0)->get_type()->print();
+    os << " ";
+    print_as_op(os, this->get_operand(0), false);
+    os << ", ";
     if (Type::is_eq_type(this->get_operand(0)->get_type(), this->get_operand(1)->get_type()))
     {
-        instr_ir += print_as_op(this->get_operand(1), false);
+        print_as_op(os, this->get_operand(1), false);
     }
     else
     {
-        instr_ir += print_as_op(this->get_operand(1), true);
+        print_as_op(os, this->get_operand(1), true);
     }
-    return instr_ir;
 }
 
 bool CmpInst::isStaticCalculable() {
-    auto cl = dynamic_cast<ConstantInt *>(get_operand(0));
-    auto cr = dynamic_cast<ConstantInt *>(get_operand(1));
-    return cl != nullptr && cr != nullptr;
+    return isa<ConstantInt>(get_operand(0)) && isa<ConstantInt>(get_operand(1));
 }
 
 int CmpInst::calculate() {
     assert(isStaticCalculable() && "Only static op can be calculated");
-    auto cl = dynamic_cast<ConstantInt *>(get_operand(0))->get_value();
-    auto cr = dynamic_cast<ConstantInt *>(get_operand(1))->get_value();
-    switch (get_cmp_op()) {
+    auto cl = cast<ConstantInt>(get_operand(0))->get_value();
+    auto cr = cast<ConstantInt>(get_operand(1))->get_value();
+    return calculate(get_cmp_op(), cl, cr);
+}
+
+int CmpInst::calculate(CmpOp op, int cl, int cr)
+{
+    switch (op) {
         case GT:
             return cl > cr;
         case GE:
@@ -235,6 +371,7 @@ int CmpInst::calculate() {
         default:
             assert(0 && "Invalid instr type");
     }
+    return 0;
 }
 
 CallInst::CallInst(Function *func, std::vector<Value *> args, BasicBlock *bb)
@@ -250,7 +387,7 @@ CallInst::CallInst(Function *func, std::vector<Value *> args, BasicBlock *bb)
 
 CallInst *CallInst::create(Function *func, std::vector<Value *> args, BasicBlock *bb)
 {
-    return new CallInst(func, args, bb);
+    return new (bb, hung_off) CallInst(func, args, bb);
 }
 
 FunctionType *CallInst::get_function_type() const
@@ -258,33 +395,31 @@ FunctionType *CallInst::get_function_type() const
     return static_cast<FunctionType *>(get_operand(0)->get_type());
 }
 
-std::string CallInst::print()
+void CallInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
     if( !this->is_void() )
     {
-        instr_ir += "%";
-        instr_ir += this->get_name();
-        instr_ir += " = ";
+        os << "%";
+        os << this->get_name();
+        os << " = ";
     }
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += this->get_function_type()->get_return_type()->print();    
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << this->get_function_type()->get_return_type()->print();    
     
-    instr_ir += " ";
-    assert(dynamic_cast<Function *>(this->get_operand(0)) && "Wrong call operand function");
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += "(";
+    os << " ";
+    assert(isa<Function>(this->get_operand(0)) && "Wrong call operand function");
+    print_as_op(os, this->get_operand(0), false);
+    os << "(";
     for (int i = 1; i < (int)this->get_num_operand(); i++)
     {
         if( i > 1 )
-            instr_ir += ", ";
-        instr_ir += this->get_operand(i)->get_type()->print();
-        instr_ir += " ";
-        instr_ir += print_as_op(this->get_operand(i), false);
+            os << ", ";
+        os << this->get_operand(i)->get_type()->print();
+        os << " ";
+        print_as_op(os, this->get_operand(i), false);
     }
-    instr_ir += ")";
-    return instr_ir;
+    os << ")";
 }
 
 BranchInst::BranchInst(Value *cond, BasicBlock *if_true, BasicBlock *if_false,
@@ -305,18 +440,12 @@ BranchInst::BranchInst(BasicBlock *if_true, BasicBlock *bb)
 BranchInst *BranchInst::create_cond_br(Value *cond, BasicBlock *if_true, BasicBlock *if_false,
                                     BasicBlock *bb)
 {
-    if_true->add_pre_basic_block(bb);
-    if_false->add_pre_basic_block(bb);
-    bb->add_succ_basic_block(if_false);
-    bb->add_succ_basic_block(if_true);
-    return new BranchInst(cond, if_true, if_false, bb);
+    return new (bb, 3) BranchInst(cond, if_true, if_false, bb);
 }
 
 BranchInst *BranchInst::create_br(BasicBlock *if_true, BasicBlock *bb)
 {
-    if_true->add_pre_basic_block(bb);
-    bb->add_succ_basic_block(if_true);
-    return new BranchInst(if_true, bb);
+    return new (bb, 1) BranchInst(if_true, bb);
 }
 
 bool BranchInst::is_cond_br() const
@@ -324,21 +453,19 @@ bool BranchInst::is_cond_br() const
     return (int)get_num_operand() == 3;
 }
 
-std::string BranchInst::print()
+void BranchInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    // instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += print_as_op(this->get_operand(0), true);
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    // os << this->get_operand(0)->get_type()->print();
+    print_as_op(os, this->get_operand(0), true);
     if( is_cond_br() )
     {
-        instr_ir += ", ";
-        instr_ir += print_as_op(this->get_operand(1), true);
-        instr_ir += ", ";
-        instr_ir += print_as_op(this->get_operand(2), true);
+        os << ", ";
+        print_as_op(os, this->get_operand(1), true);
+        os << ", ";
+        print_as_op(os, this->get_operand(2), true);
     }
-    return instr_ir;
 }
 
 ReturnInst::ReturnInst(Value *val, BasicBlock *bb)
@@ -355,12 +482,12 @@ ReturnInst::ReturnInst(BasicBlock *bb)
 
 ReturnInst *ReturnInst::create_ret(Value *val, BasicBlock *bb)
 {
-    return new ReturnInst(val, bb);
+    return new (bb, 1) ReturnInst(val, bb);
 }
 
 ReturnInst *ReturnInst::create_void_ret(BasicBlock *bb)
 {
-    return new ReturnInst(bb);
+    return new (bb, 0) ReturnInst(bb);
 }
 
 bool ReturnInst::is_void_ret() const
@@ -368,23 +495,21 @@ bool ReturnInst::is_void_ret() const
     return (int)get_num_operand() == 0;
 }
 
-std::string ReturnInst::print()
+void ReturnInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
     if ( !is_void_ret() )
     {
-        instr_ir += this->get_operand(0)->get_type()->print();
-        instr_ir += " ";
-        instr_ir += print_as_op(this->get_operand(0), false);
+        os << this->get_operand(0)->get_type()->print();
+        os << " ";
+        print_as_op(os, this->get_operand(0), false);
     }
     else
     {
-        instr_ir += "void";
+        os << "void";
     }
     
-    return instr_ir;
 }
 
 GetElementPtrInst::GetElementPtrInst(Value *ptr, std::vector<Value *> idxs, BasicBlock *bb)
@@ -426,29 +551,27 @@ Type *GetElementPtrInst::get_element_type() const
 
 GetElementPtrInst *GetElementPtrInst::create_gep(Value *ptr, std::vector<Value *> idxs, BasicBlock *bb)
 {
-    return new GetElementPtrInst(ptr, idxs, bb);
+    return new (bb, 1 + idxs.size()) GetElementPtrInst(ptr, idxs, bb);
 }
 
-std::string GetElementPtrInst::print()
+void GetElementPtrInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
     assert(this->get_operand(0)->get_type()->is_pointer_type());
-    instr_ir += this->get_operand(0)->get_type()->get_pointer_element_type()->print();
-    instr_ir += ", ";
+    os << this->get_operand(0)->get_type()->get_pointer_element_type()->print();
+    os << ", ";
     for (int i = 0; i < (int)this->get_num_operand(); i++)
     {
         if( i > 0 )
-            instr_ir += ", ";
-        instr_ir += this->get_operand(i)->get_type()->print();
-        instr_ir += " ";
-        instr_ir += print_as_op(this->get_operand(i), false);
+            os << ", ";
+        os << this->get_operand(i)->get_type()->print();
+        os << " ";
+        print_as_op(os, this->get_operand(i), false);
     }
-    return instr_ir;
 }
 
 StoreInst::StoreInst(Value *val, Value *ptr, BasicBlock *bb)
@@ -460,21 +583,19 @@ StoreInst::StoreInst(Value *val, Value *ptr, BasicBlock *bb)
 
 StoreInst *StoreInst::create_store(Value *val, Value *ptr, BasicBlock *bb)
 {
-    return new StoreInst(val, ptr, bb);
+    return new (bb, 2) StoreInst(val, ptr, bb);
 }
 
-std::string StoreInst::print()
+void StoreInst::print_ir(OutStream &os)
 {
     // store i32 3, i32* %ptr
-    std::string instr_ir;
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += ", ";
-    instr_ir += print_as_op(this->get_operand(1), true);
-    return instr_ir;
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << this->get_operand(0)->get_type()->print();
+    os << " ";
+    print_as_op(os, this->get_operand(0), false);
+    os << ", ";
+    print_as_op(os, this->get_operand(1), true);
 }
 
 LoadInst::LoadInst(Type *ty, Value *ptr, BasicBlock *bb)
@@ -487,7 +608,7 @@ LoadInst::LoadInst(Type *ty, Value *ptr, BasicBlock *bb)
 
 LoadInst *LoadInst::create_load(Type *ty, Value *ptr, BasicBlock *bb)
 {
-    return new LoadInst(ty, ptr, bb);
+    return new (bb, 1) LoadInst(ty, ptr, bb);
 }
 
 Type *LoadInst::get_load_type() const
@@ -495,21 +616,19 @@ Type *LoadInst::get_load_type() const
     return static_cast<PointerType *>(get_operand(0)->get_type())->get_element_type();
 }
 
-std::string LoadInst::print()
+void LoadInst::print_ir(OutStream &os)
 {
     // %val = load i32* %ptr   
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
     assert(this->get_operand(0)->get_type()->is_pointer_type());
-    instr_ir += this->get_operand(0)->get_type()->get_pointer_element_type()->print();
-    instr_ir += ",";
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), true);
-    return instr_ir;
+    os << this->get_operand(0)->get_type()->get_pointer_element_type()->print();
+    os << ",";
+    os << " ";
+    print_as_op(os, this->get_operand(0), true);
 }
 
 AllocaInst::AllocaInst(Type *ty, BasicBlock *bb)
@@ -520,24 +639,22 @@ AllocaInst::AllocaInst(Type *ty, BasicBlock *bb)
 
 AllocaInst *AllocaInst::create_alloca(Type *ty, BasicBlock *bb)
 {
-    return new AllocaInst(ty, bb);
+    return new (bb, 0) AllocaInst(ty, bb);
 }
 Type *AllocaInst::get_alloca_type() const
 {
     return alloca_ty_;
 }
 
-std::string AllocaInst::print()
+void AllocaInst::print_ir(OutStream &os)
 {
     // %ptr = alloca i32    
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += get_alloca_type()->print();
-    return instr_ir;    
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << get_alloca_type()->print();
 }
 
 ZextInst::ZextInst(OpID op, Value *val, Type *ty, BasicBlock *bb)
@@ -548,7 +665,7 @@ ZextInst::ZextInst(OpID op, Value *val, Type *ty, BasicBlock *bb)
 
 ZextInst *ZextInst::create_zext(Value *val, Type *ty, BasicBlock *bb)
 {
-    return new ZextInst(Instruction::zext, val, ty, bb);
+    return new (bb, 1) ZextInst(Instruction::zext, val, ty, bb);
 }
 
 Type *ZextInst::get_dest_type() const
@@ -556,20 +673,18 @@ Type *ZextInst::get_dest_type() const
     return dest_ty_;
 }
 
-std::string ZextInst::print()
+void ZextInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
-    instr_ir += print_as_op(this->get_operand(0), false);
-    instr_ir += " to ";
-    instr_ir += this->get_dest_type()->print();
-    return instr_ir; 
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << this->get_operand(0)->get_type()->print();
+    os << " ";
+    print_as_op(os, this->get_operand(0), false);
+    os << " to ";
+    os << this->get_dest_type()->print();
 }
 
 PhiInst::PhiInst(OpID op, std::vector<Value *> vals, std::vector<BasicBlock *> val_bbs, Type *ty, BasicBlock *bb)
@@ -587,47 +702,48 @@ PhiInst *PhiInst::create_phi( Type *ty, BasicBlock *bb)
 {
     std::vector<Value *> vals;
     std::vector<BasicBlock *> val_bbs;
-    return new PhiInst(Instruction::phi, vals, val_bbs, ty, bb);
+    return new (bb, hung_off) PhiInst(Instruction::phi, vals, val_bbs, ty, bb);
 }
 
-std::string PhiInst::print()
+void PhiInst::print_ir(OutStream &os)
 {
-    std::string instr_ir;
-    instr_ir += "%";
-    instr_ir += this->get_name();
-    instr_ir += " = ";
-    instr_ir += this->get_module()->get_instr_op_name( this->get_instr_type() );
-    instr_ir += " ";
-    instr_ir += this->get_operand(0)->get_type()->print();
-    instr_ir += " ";
+    os << "%";
+    os << this->get_name();
+    os << " = ";
+    os << this->get_module()->get_instr_op_name( this->get_instr_type() );
+    os << " ";
+    os << this->get_operand(0)->get_type()->print();
+    os << " ";
     for (int i = 0; i < (int)this->get_num_operand()/2; i++)
     {
         if( i > 0 )
-            instr_ir += ", ";
-        instr_ir += "[ ";
-        instr_ir += print_as_op(this->get_operand(2*i), false);
-        instr_ir += ", ";
-        instr_ir += print_as_op(this->get_operand(2*i+1), false);
-        instr_ir += " ]";
+            os << ", ";
+        os << "[ ";
+        print_as_op(os, this->get_operand(2*i), false);
+        os << ", ";
+        print_as_op(os, this->get_operand(2*i+1), false);
+        os << " ]";
     }
     if ( (int)this->get_num_operand()/2 < (int)(this->get_parent()->get_pre_basic_blocks().size()) )
     {
         for ( auto pre_bb : this->get_parent()->get_pre_basic_blocks() )
         {
-            if (std::find(this->get_operands().begin(), this->get_operands().end(), static_cast<Value *>(pre_bb)) == this->get_operands().end())
+            auto ops = this->get_operands();
+            if (std::find(ops.begin(), ops.end(), static_cast<Value *>(pre_bb)) == ops.end())
             {
                 // find a pre_bb is not in phi
-                instr_ir += ", [ undef, " +print_as_op(pre_bb, false)+" ]";
+                os << ", [ undef, ";
+                print_as_op(os, pre_bb, false);
+                os << " ]";
             }
         }
     }
-    return instr_ir; 
 }
 
 std::list<std::pair<Value *, BasicBlock *>> PhiInst::getValueBBPair() {
     std::list<std::pair<Value *, BasicBlock *>> ret;
     for (int i = 0; i < (int)get_num_operand(); i += 2) {
-        ret.emplace_back(get_operand(i), dynamic_cast<BasicBlock *>(get_operand(i + 1)));
+        ret.emplace_back(get_operand(i), cast<BasicBlock>(get_operand(i + 1)));
     }
     return ret;
 }
@@ -636,15 +752,15 @@ BranchInst::BranchInst(int op_num, BasicBlock *bb): Instruction(Type::get_void_t
 
 BasicBlock *BranchInst::getTrueBB() const {
     if (is_cond_br()) {
-        return dynamic_cast<BasicBlock *>(get_operand(1));
+        return cast<BasicBlock>(get_operand(1));
     } else {
-        return dynamic_cast<BasicBlock *>(get_operand(0));
+        return cast<BasicBlock>(get_operand(0));
     }
 }
 
 BasicBlock *BranchInst::getFalseBB() const {
     assert(is_cond_br() && "Only condition branch has a false block");
-    return dynamic_cast<BasicBlock *>(get_operand(2));
+    return cast<BasicBlock>(get_operand(2));
 };
 ReturnInst::ReturnInst(BasicBlock *bb, size_t num_op): Instruction(Type::get_void_type(bb->get_module()), Instruction::ret, num_op, bb){};
 StoreInst::StoreInst(BasicBlock *bb): Instruction(Type::get_void_type(bb->get_module()), Instruction::store, 2, bb){};
\ No newline at end of file
@@ -6,17 +6,41 @@
  */
 #include "Module.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
 #include <utility>
 
-Module::Module(std::string name) : module_name_(std::move(name)) {
-  /// @brief 创建类型指针对象
-  /// @param name
-  void_ty_ = new Type(Type::VoidTyID, this);
-  label_ty_ = new Type(Type::LabelTyID, this);
-  int1_ty_ = new IntegerType(1, this);
-  int32_ty_ = new IntegerType(32, this);
-  float32_ty_ = new FloatType(this);
+namespace {
+/// @brief 下一个模块序号，从1开始，0表示线程局部缓存为空
+std::atomic<std::uint64_t> next_module_serial{1};
+/// @brief 函数少于此数时串行打印，线程创建的开销不值得
+constexpr std::size_t MinParallelPrintFunctions = 32;
+/// @brief 每个打印线程最多领先输出位置的函数个数，限制缓冲区的峰值内存
+constexpr std::size_t PrintWindowPerThread = 8;
 
+/**
+ * @brief 从登记表中撤销类型
+ *
+ * @param types 登记表
+ * @param ty 类型指针
+ * @return true ty在该登记表中且已撤销
+ */
+bool remove_owned(std::vector<Type *> &types, Type *ty) {
+  auto it = std::find(types.rbegin(), types.rend(), ty);
+  if (it == types.rend()) {
+    return false;
+  }
+  types.erase(std::next(it).base());
+  return true;
+}
+} // namespace
+
+Module::Module(std::string name)
+    : name_pool_(this), owner_(std::this_thread::get_id()),
+      serial_(next_module_serial.fetch_add(1, std::memory_order_relaxed)),
+      type_ctx_(this), const_ctx_(this), module_name_(std::move(name)) {
   /// @brief id 与 字符串的映射添加
   instr_id2string_.insert({Instruction::ret, "ret"});
   instr_id2string_.insert({Instruction::br, "br"});
@@ -41,38 +65,183 @@ Module::Module(std::string name) : module_name_(std::move(name)) {
 /**
  * @brief Destroy the Module:: Module object 析构函数
  *
+ * @note 先摘除所有use节点，使析构顺序与use关系无关
+ * @note 析构登记的value和类型，内存随内存池一次释放
  */
 Module::~Module() {
-  delete void_ty_;
-  delete label_ty_;
-  delete int1_ty_;
-  delete int32_ty_;
-  delete float32_ty_;
+  std::vector<std::vector<Value *> *> values{&owned_values_};
+  std::vector<std::vector<Type *> *> types{&owned_types_};
+  for (auto &entry : thread_heaps_) {
+    values.push_back(&entry.second->owned_values_);
+    types.push_back(&entry.second->owned_types_);
+  }
+  for (auto list : values) {
+    for (auto v : *list) {
+      if (auto user = dyn_cast<User>(v)) {
+        user->remove_use_of_ops();
+      }
+    }
+  }
+  // value析构时从登记表尾部撤销自身
+  for (auto list : values) {
+    while (!list->empty()) {
+      list->back()->~Value();
+    }
+  }
+  for (auto list : types) {
+    for (auto it = list->rbegin(); it != list->rend(); ++it) {
+      (*it)->~Type();
+    }
+  }
+}
+/**
+ * @brief 获取当前线程的分配堆
+ *
+ * @return Module::ThreadHeap* 创建模块的线程为空，其余线程为各自的堆
+ * @note 线程局部缓存最近使用的模块，命中时无需加锁
+ */
+Module::ThreadHeap *Module::get_thread_heap() {
+  struct Cache {
+    std::uint64_t serial_ = 0;
+    ThreadHeap *heap_ = nullptr;
+  };
+  thread_local Cache cache;
+  if (cache.serial_ == serial_) {
+    return cache.heap_;
+  }
+  ThreadHeap *heap = nullptr;
+  if (std::this_thread::get_id() != owner_) {
+    std::lock_guard<std::mutex> lock(thread_heaps_mutex_);
+    auto &slot = thread_heaps_[std::this_thread::get_id()];
+    if (slot == nullptr) {
+      slot = std::make_unique<ThreadHeap>();
+    }
+    heap = slot.get();
+  }
+  cache.serial_ = serial_;
+  cache.heap_ = heap;
+  return heap;
+}
+/**
+ * @brief 从模块内存池分配内存
+ *
+ * @param size 字节数
+ * @param align 对齐要求
+ * @param kind 对象种类，用于统计
+ * @return void* 内存起始地址
+ * @note 工作线程从各自的分配堆分配，互不加锁
+ */
+void *Module::allocate(std::size_t size, std::size_t align, Arena::Kind kind) {
+  ThreadHeap *heap = get_thread_heap();
+  return (heap != nullptr ? heap->arena_ : arena_).allocate(size, align, kind);
+}
+/**
+ * @brief 登记value，模块析构时调用其析构函数
+ *
+ * @param v value指针
+ */
+void Module::own(Value *v) {
+  ThreadHeap *heap = get_thread_heap();
+  auto &values = heap != nullptr ? heap->owned_values_ : owned_values_;
+  std::lock_guard<std::mutex> lock(heap != nullptr ? heap->owned_values_mutex_
+                                                   : owned_values_mutex_);
+  v->owned_slot_ = values.size();
+  values.push_back(v);
+}
+/**
+ * @brief 登记类型，模块析构时调用其析构函数
+ *
+ * @param ty 类型指针
+ */
+void Module::own(Type *ty) {
+  ThreadHeap *heap = get_thread_heap();
+  (heap != nullptr ? heap->owned_types_ : owned_types_).push_back(ty);
+}
+/**
+ * @brief 撤销value的登记，由value的析构函数调用
+ *
+ * @param v value指针
+ * @note 先查当前线程的登记表，O(1)；由其他线程创建的value再逐个查其余登记表
+ * @note 每个登记表由各自的锁保护，其他线程删除value时不与登记表所属线程竞争
+ */
+void Module::disown(Value *v) {
+  // 用登记表尾部的value填补空位，O(1)；owned_slot_随填补修改，须在锁内读取
+  auto remove = [v](std::vector<Value *> &values, std::mutex &mutex) {
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned slot = v->owned_slot_;
+    if (slot >= values.size() || values[slot] != v) {
+      return false;
+    }
+    Value *last = values.back();
+    last->owned_slot_ = slot;
+    values[slot] = last;
+    values.pop_back();
+    return true;
+  };
+  ThreadHeap *heap = get_thread_heap();
+  if (heap != nullptr
+          ? remove(heap->owned_values_, heap->owned_values_mutex_)
+          : remove(owned_values_, owned_values_mutex_)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(thread_heaps_mutex_);
+  if (heap != nullptr && remove(owned_values_, owned_values_mutex_)) {
+    return;
+  }
+  for (auto &entry : thread_heaps_) {
+    auto other = entry.second.get();
+    if (other != heap &&
+        remove(other->owned_values_, other->owned_values_mutex_)) {
+      return;
+    }
+  }
+}
+/**
+ * @brief 撤销类型的登记，用于构造失败的对象
+ *
+ * @param ty 类型指针
+ */
+void Module::disown(Type *ty) {
+  ThreadHeap *heap = get_thread_heap();
+  remove_owned(heap != nullptr ? heap->owned_types_ : owned_types_, ty);
+}
+/**
+ * @brief 打印各种类对象的内存占用
+ *
+ * @return std::string 含各工作线程分配堆的合计
+ */
+std::string Module::print_memory_usage() {
+  std::vector<const Arena *> arenas{&arena_};
+  std::lock_guard<std::mutex> lock(thread_heaps_mutex_);
+  for (auto &entry : thread_heaps_) {
+    arenas.push_back(&entry.second->arena_);
+  }
+  return Arena::print_usage(arenas);
 }
 /**
  * @brief Get the void type object，获取一个构建好的void类型指针
  *
  * @return Type*
  */
-Type *Module::get_void_type() { return void_ty_; }
+Type *Module::get_void_type() { return type_ctx_.get_void_type(); }
 /**
  * @brief Get the label type object，获取一个构建好的label类型指针
  *
  * @return Type*
  */
-Type *Module::get_label_type() { return label_ty_; }
+Type *Module::get_label_type() { return type_ctx_.get_label_type(); }
 /**
  * @brief Get the int1 type object，获取一个构建好的integer1类型指针
  *
  * @return IntegerType*
  */
-IntegerType *Module::get_int1_type() { return int1_ty_; }
+IntegerType *Module::get_int1_type() { return type_ctx_.get_int1_type(); }
 /**
  * @brief Get the int32 type object，获取一个构建好的integer32类型指针
  *
  * @return IntegerType*
  */
-IntegerType *Module::get_int32_type() { return int32_ty_; }
+IntegerType *Module::get_int32_type() { return type_ctx_.get_int32_type(); }
 /**
  * @brief Get the pointer type object，获取一个构建好的指针类型指针
  *
@@ -80,10 +249,7 @@ IntegerType *Module::get_int32_type() { return int32_ty_; }
  * @return PointerType*
  */
 PointerType *Module::get_pointer_type(Type *contained) {
-  if (pointer_map_.find(contained) == pointer_map_.end()) {
-    pointer_map_[contained] = new PointerType(contained);
-  }
-  return pointer_map_[contained];
+  return type_ctx_.get_pointer_type(contained);
 }
 /**
  * @brief Get the array type object，获取一个构建好的array类型指针
@@ -93,11 +259,7 @@ PointerType *Module::get_pointer_type(Type *contained) {
  * @return ArrayType*
  */
 ArrayType *Module::get_array_type(Type *contained, unsigned num_elements) {
-  if (array_map_.find({contained, num_elements}) == array_map_.end()) {
-    array_map_[{contained, num_elements}] =
-        new ArrayType(contained, num_elements);
-  }
-  return array_map_[{contained, num_elements}];
+  return type_ctx_.get_array_type(contained, num_elements);
 }
 /**
  * @brief Get the int32 ptr type object，获取一个构建好的integer32指针类型指针
@@ -105,21 +267,21 @@ ArrayType *Module::get_array_type(Type *contained, unsigned num_elements) {
  * @return PointerType*
  */
 PointerType *Module::get_int32_ptr_type() {
-  return get_pointer_type(int32_ty_);
+  return get_pointer_type(type_ctx_.get_int32_type());
 }
 /**
  * @brief Get the float type object，获取一个构建好的float类型指针
  *
  * @return FloatType*
  */
-FloatType *Module::get_float_type() { return float32_ty_; }
+FloatType *Module::get_float_type() { return type_ctx_.get_float_type(); }
 /**
  * @brief Get the float ptr type object，获取一个构建好的float指针类型指针
  *
  * @return PointerType*
  */
 PointerType *Module::get_float_ptr_type() {
-  return get_pointer_type(float32_ty_);
+  return get_pointer_type(type_ctx_.get_float_type());
 }
 /**
  * @brief 添加函数
@@ -149,6 +311,29 @@ void Module::add_global_variable(GlobalVariable *g) {
 std::list<GlobalVariable *> Module::get_global_variable() {
   return global_list_;
 }
+/**
+ * @brief 读取函数体，由Function::materialize调用
+ *
+ * @param f 函数体尚未读取的函数
+ * @return true 读取成功
+ * @return false 没有读取器或函数体格式错误
+ */
+bool Module::materialize(Function *f) {
+  return materializer_ != nullptr && materializer_->materialize(f);
+}
+/**
+ * @brief 读取全部尚未读取的函数体
+ *
+ * @return true 全部读取成功
+ * @return false 有函数体格式错误，其余函数体照常读取
+ */
+bool Module::materialize_all() {
+  bool ok = true;
+  for (auto func : function_list_) {
+    ok &= func->materialize();
+  }
+  return ok;
+}
 /**
  * @brief Set the print name object，修正模块管理的函数下的名称
  *
@@ -166,13 +351,100 @@ void Module::set_print_name() {
  */
 std::string Module::print() {
   std::string module_ir;
+  StringOutStream os(module_ir);
+  print(os);
+  return module_ir;
+}
+/**
+ * @brief 将中间代码打印到输出流
+ *
+ * @param os 输出流
+ * @note 按硬件线程数并行打印各函数
+ */
+void Module::print(OutStream &os) { print(os, 0); }
+/**
+ * @brief 用给定线程数将中间代码打印到输出流
+ *
+ * @param os 输出流
+ * @param num_threads 打印函数的线程数，为0时取硬件线程数，为1时串行打印
+ * @note 全局量在调用线程中直接写入输出流
+ * @note 工作线程按声明顺序领取函数，各自打印到函数的缓冲区；
+ * 调用线程按声明顺序等待并写出缓冲区，输出与串行打印逐字节相同
+ * @note 命名按函数独立进行，名称经分片加锁的字符串池收录，函数之间不共享计数
+ * @note 工作线程最多领先输出位置若干个函数，缓冲区的峰值内存与模块大小无关
+ */
+void Module::print(OutStream &os, unsigned num_threads) {
   for (auto global_val : this->global_list_) {
-    module_ir += global_val->print();
-    module_ir += "\n";
+    global_val->print(os);
+    os << '\n';
   }
-  for (auto func : this->function_list_) {
-    module_ir += func->print();
-    module_ir += "\n";
+  std::vector<Function *> funcs(function_list_.begin(), function_list_.end());
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads = static_cast<unsigned>(
+      std::min<std::size_t>(num_threads, funcs.size()));
+  if (num_threads <= 1 || funcs.size() < MinParallelPrintFunctions) {
+    for (auto func : funcs) {
+      func->print(os);
+      os << '\n';
+    }
+    return;
+  }
+
+  // 读取函数体会修改模块，须在工作线程开始之前完成
+  materialize_all();
+  const std::size_t window = PrintWindowPerThread * num_threads;
+  std::vector<std::string> buffers(funcs.size());
+  std::vector<char> ready(funcs.size(), 0);
+  std::size_t next = 0;    // 下一个待领取的函数
+  std::size_t written = 0; // 下一个待写出的函数
+  std::mutex mutex;
+  std::condition_variable produced; // 有函数打印完成
+  std::condition_variable consumed; // 输出位置前进
+
+  auto worker = [&] {
+    for (;;) {
+      std::size_t i;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        consumed.wait(lock, [&] {
+          return next == funcs.size() || next < written + window;
+        });
+        if (next == funcs.size()) {
+          return;
+        }
+        i = next++;
+      }
+      StringOutStream func_os(buffers[i]);
+      funcs[i]->print(func_os);
+      func_os << '\n';
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready[i] = 1;
+      }
+      produced.notify_one();
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (unsigned t = 0; t < num_threads; t++) {
+    threads.emplace_back(worker);
+  }
+  for (std::size_t i = 0; i < funcs.size(); i++) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      produced.wait(lock, [&] { return ready[i] != 0; });
+    }
+    os << buffers[i];
+    std::string().swap(buffers[i]);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      written = i + 1;
+    }
+    consumed.notify_all();
+  }
+  for (auto &thread : threads) {
+    thread.join();
   }
-  return module_ir;
 }
@@ -0,0 +1,159 @@
+/*!
+ *@file OutStream.cpp
+ *@brief 带缓冲的输出流接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#include "OutStream.h"
+
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <fcntl.h>
+#include <limits>
+#include <string>
+#include <unistd.h>
+
+/*!
+ *@brief 输出流构造函数
+ *@param buf_size 缓冲区大小，为0时不缓冲
+ */
+OutStream::OutStream(std::size_t buf_size)
+    : buf_(buf_size != 0 ? new char[buf_size] : nullptr), cur_(buf_),
+      end_(buf_ + buf_size) {}
+
+/*!
+ *@brief 输出流析构函数
+ *@note 此时子类已析构，不能再写出，由子类析构函数负责flush
+ */
+OutStream::~OutStream() { delete[] buf_; }
+
+/*!
+ *@brief 将缓冲区中的数据全部写出
+ */
+void OutStream::flush() {
+  if (cur_ != buf_) {
+    write_impl(buf_, cur_ - buf_);
+    cur_ = buf_;
+  }
+}
+
+/*!
+ *@brief 缓冲区放不下时的写入
+ *@param data 数据
+ *@param size 字节数
+ *@note
+ *---------
+ *先写出已缓冲的数据；不小于缓冲区的写入直接写出，否则放入空的缓冲区
+ */
+void OutStream::write_slow(const char *data, std::size_t size) {
+  if (size == 0) {
+    return;
+  }
+  flush();
+  if (size >= static_cast<std::size_t>(end_ - buf_)) {
+    write_impl(data, size);
+    return;
+  }
+  std::memcpy(cur_, data, size);
+  cur_ += size;
+}
+
+/*!
+ *@brief 写入十进制整数
+ *@param val 整数值
+ *@return 输出流自身
+ *@note 缓冲区剩余空间足够时直接格式化到缓冲区，否则经栈上数组写入
+ */
+template <typename T> OutStream &OutStream::write_integer(T val) {
+  constexpr std::size_t max_digits = std::numeric_limits<T>::digits10 + 2;
+  if (static_cast<std::size_t>(end_ - cur_) >= max_digits) {
+    cur_ = std::to_chars(cur_, end_, val).ptr;
+    return *this;
+  }
+  char buf[max_digits];
+  char *last = std::to_chars(buf, buf + max_digits, val).ptr;
+  return write(buf, last - buf);
+}
+
+OutStream &OutStream::operator<<(int val) { return write_integer(val); }
+
+OutStream &OutStream::operator<<(unsigned val) { return write_integer(val); }
+
+OutStream &OutStream::operator<<(long long val) { return write_integer(val); }
+
+OutStream &OutStream::operator<<(unsigned long long val) {
+  return write_integer(val);
+}
+
+/*!
+ *@brief 写入定宽的大写十六进制数
+ *@param val 整数值
+ *@param width 位数，高位补0，超出的高位被截去
+ *@return 输出流自身
+ *@note std::to_chars只输出小写且不补0，此处按半字节查表
+ */
+OutStream &OutStream::write_hex(unsigned long long val, unsigned width) {
+  static constexpr char digits[] = "0123456789ABCDEF";
+  char buf[16];
+  assert(width <= sizeof(buf) && "hex width out of range");
+  for (unsigned i = width; i-- > 0;) {
+    buf[i] = digits[val & 0xF];
+    val >>= 4;
+  }
+  return write(buf, width);
+}
+
+/*!
+ *@brief 写入已打开的文件描述符
+ *@param fd 文件描述符
+ *@param owns_fd 析构时是否关闭
+ */
+FdOutStream::FdOutStream(int fd, bool owns_fd)
+    : OutStream(DefaultBufferSize), fd_(fd), owns_fd_(owns_fd) {}
+
+/*!
+ *@brief 创建或截断文件并写入
+ *@param path 文件路径
+ */
+FdOutStream::FdOutStream(const std::string &path)
+    : OutStream(DefaultBufferSize),
+      fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)),
+      owns_fd_(true) {
+  error_ = fd_ < 0;
+}
+
+/*!
+ *@brief 写出剩余数据，按需关闭文件描述符
+ */
+FdOutStream::~FdOutStream() {
+  flush();
+  if (owns_fd_ && fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+/*!
+ *@brief 写出一块数据
+ *@param data 数据
+ *@param size 字节数
+ *@note 部分写入时继续写剩余部分，被信号中断时重试，其他错误记录后放弃
+ */
+void FdOutStream::write_impl(const char *data, std::size_t size) {
+  if (fd_ < 0) {
+    return;
+  }
+  while (size != 0) {
+    ssize_t n = ::write(fd_, data, size);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error_ = true;
+      return;
+    }
+    data += n;
+    size -= n;
+  }
+}
@@ -0,0 +1,34 @@
+/*!
+ *@file StringPool.cpp
+ *@brief 字符串池接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+
+#include "StringPool.h"
+#include "Module.h"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+/*!
+ *@brief 收录字符串
+ *@param str 待收录的字符串
+ *@return 池中字符串的指针，内容相同的字符串返回同一指针
+ *@note
+ *---------
+ *未收录时将字符复制到内存池，并在池中保存指向这些字符的视图；
+ *表中的键即该视图，返回视图的地址，不随散列表扩容改变
+ */
+const std::string_view *StringPool::intern(std::string_view str) {
+  return strings_.get_or_create(str, [&] {
+    char *chars =
+        static_cast<char *>(m_->allocate(str.size(), 1, Arena::StringKind));
+    std::memcpy(chars, str.data(), str.size());
+    void *mem = m_->allocate(sizeof(std::string_view),
+                             alignof(std::string_view), Arena::StringKind);
+    auto view = new (mem) std::string_view(chars, str.size());
+    return std::make_pair(*view, static_cast<const std::string_view *>(view));
+  });
+}
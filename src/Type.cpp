@@ -8,6 +8,9 @@
 #include "Module.h"
 
 #include <cassert>
+#include <charconv>
+#include <cstring>
+#include <utility>
 
 /**
  * @brief Construct a new Type object
@@ -18,6 +21,34 @@
 Type::Type(TypeID tid, Module *m) {
   tid_ = tid;
   m_ = m;
+  size_ = get_primitive_size(tid);
+  align_ = size_ ? size_ : 1;
+  if (tid != FunctionTyID && tid != ArrayTyID && tid != PointerTyID) {
+    cache_spelling();
+  }
+}
+/**
+ * @brief 从模块内存池分配类型对象
+ *
+ * @param size 对象大小
+ * @param m 所属模块
+ * @return void* 对象起始地址
+ * @note 对象登记到模块中，由模块析构时统一析构
+ */
+void *Type::operator new(std::size_t size, Module *m) {
+  Type *ty =
+      static_cast<Type *>(m->allocate(size, alignof(Type), Arena::TypeKind));
+  m->own(ty);
+  return ty;
+}
+/**
+ * @brief 构造失败时撤销登记
+ *
+ * @param ptr 对象指针
+ * @param m 所属模块
+ */
+void Type::operator delete(void *ptr, Module *m) {
+  m->disown(static_cast<Type *>(ptr));
 }
 /**
  * @brief Get the module object，获取所属模块
@@ -129,36 +160,23 @@ Type *Type::get_array_element_type() {
  *
  * @param extended 范围是否延申，即在判定数组指针时，是否计算指向的数组大小
  * @return int 大小
- * @note 如果是整数，那么返回32或1
- * @note 如果是数组，那么返回元素大小乘元素个数
+ * @note 基础类型的大小为常量，数组的大小在创建时由元素大小乘元素个数得到
  * @note 如果是指针，那么返回指针大小或是指针指向数组的大小
  */
 int Type::get_size(bool extended) {
-  if (this->is_integer_type()) {
-    auto bits = static_cast<IntegerType *>(this)->get_num_bits() / 8;
-    return bits > 0 ? bits : 1;
-  }
-  if (this->is_array_type()) {
-    auto element_size =
-        static_cast<ArrayType *>(this)->get_element_type()->get_size();
-    auto num_elements = static_cast<ArrayType *>(this)->get_num_of_elements();
-    return element_size * num_elements;
+  if (extended && this->is_pointer_type() &&
+      this->get_pointer_element_type()->is_array_type()) {
+    return this->get_pointer_element_type()->size_;
   }
-  if (this->is_pointer_type()) {
-    if (extended && this->get_pointer_element_type()->is_array_type()) {
-      return this->get_pointer_element_type()->get_size();
-    } else {
-      return 4;
-    }
-  }
-  return 0;
+  return size_;
 }
 /**
- * @brief 打印类型
+ * @brief 生成并缓存类型文本
  *
- * @return std::string，字符串
+ * @note 组成类型的文本在其创建时已缓存，此处只拼接一层
+ * @note 文本复制到模块内存池，类型唯一化后每种类型只生成一次
  */
-std::string Type::print() {
+void Type::cache_spelling() {
   std::string type_ir;
   switch (this->get_type_id()) {
   case VoidTyID:
@@ -168,9 +186,10 @@ std::string Type::print() {
     type_ir += "label";
     break;
   case IntegerTy32ID:
+    type_ir += "i32";
+    break;
   case IntegerTy1ID:
-    type_ir += "i";
-    type_ir += std::to_string(static_cast<IntegerType *>(this)->get_num_bits());
+    type_ir += "i1";
     break;
   case FunctionTyID:
     type_ir += static_cast<FunctionType *>(this)->get_return_type()->print();
@@ -189,8 +208,14 @@ std::string Type::print() {
     break;
   case ArrayTyID:
     type_ir += "[";
-    type_ir +=
-        std::to_string(static_cast<ArrayType *>(this)->get_num_of_elements());
+    {
+      char digits[16];
+      char *last = std::to_chars(digits, digits + sizeof(digits),
+                                 static_cast<ArrayType *>(this)
+                                     ->get_num_of_elements())
+                       .ptr;
+      type_ir.append(digits, last - digits);
+    }
     type_ir += " x ";
     type_ir += static_cast<ArrayType *>(this)->get_element_type()->print();
     type_ir += "]";
@@ -201,7 +226,10 @@ std::string Type::print() {
   default:
     break;
   }
-  return type_ir;
+  char *chars = static_cast<char *>(
+      m_->allocate(type_ir.size(), 1, Arena::TypeKind));
+  std::memcpy(chars, type_ir.data(), type_ir.size());
+  spelling_ = std::string_view(chars, type_ir.size());
 }
 /**
  * @brief Construct a new Void Type object
@@ -226,7 +254,7 @@ IntegerType::IntegerType(unsigned num_bits, Module *m)
  * @return IntegerType*
  */
 IntegerType *IntegerType::get(unsigned num_bits, Module *m) {
-  return new IntegerType(num_bits, m);
+  return m->get_type_context().get_int_type(num_bits);
 }
 /**
  * @brief Get the num bits object，获取整数类型对应的位数
@@ -243,15 +271,13 @@ unsigned IntegerType::get_num_bits() { return num_bits_; }
  * @return 创建对象本身
  */
 FunctionType::FunctionType(Type *result, std::vector<Type *> params)
-    : Type(Type::FunctionTyID, nullptr) {
+    : Type(Type::FunctionTyID, result->get_module()) {
   assert(is_valid_return_type(result) && "Invalid return type for function!");
   result_ = result;
-
-  for (auto p : params) {
-    // assert(is_valid_argument_type(p) && "Not a valid type for function
-    // argument!");
-    args_.push_back(p);
-  }
+  // assert(is_valid_argument_type(p) && "Not a valid type for function
+  // argument!");
+  args_ = std::move(params);
+  cache_spelling();
 }
 /**
  * @brief 判断返回类型是否有效
@@ -281,7 +307,8 @@ bool FunctionType::is_valid_argument_type(Type *ty) {
  * @return FunctionType* 函数类型指针
  */
 FunctionType *FunctionType::get(Type *result, std::vector<Type *> params) {
-  return new FunctionType(result, params);
+  return result->get_module()->get_type_context().get_function_type(
+      result, std::move(params));
 }
 /**
  * @brief Get the num of args object，获取参数个数
@@ -307,6 +334,7 @@ Type *FunctionType::get_return_type() const { return result_; }
  *
  * @param contained 数组类型
  * @param num_elements 数组元素个数
+ * @note 由元素类型的布局计算大小、对齐、标量类型与展平元素个数
  */
 ArrayType::ArrayType(Type *contained, unsigned num_elements)
     : Type(Type::ArrayTyID, contained->get_module()),
@@ -314,6 +342,18 @@ ArrayType::ArrayType(Type *contained, unsigned num_elements)
   assert(is_valid_element_type(contained) &&
          "Not a valid type for array element!");
   contained_ = contained;
+  /// 元素类型已有布局，逐层累乘即可，无需递归
+  size_ = contained->get_alloc_size() * num_elements;
+  align_ = contained->get_alignment();
+  if (contained->is_array_type()) {
+    auto inner = static_cast<ArrayType *>(contained);
+    scalar_ = inner->scalar_;
+    num_flat_ = inner->num_flat_ * num_elements;
+  } else {
+    scalar_ = contained;
+    num_flat_ = num_elements;
+  }
+  cache_spelling();
 }
 /**
  * @brief 判断元素类型是否有效
@@ -341,7 +381,9 @@ ArrayType *ArrayType::get(Type *contained, unsigned num_elements) {
  * @param contained 指针指向元素的类型
  */
 PointerType::PointerType(Type *contained)
-    : Type(Type::PointerTyID, contained->get_module()), contained_(contained) {}
+    : Type(Type::PointerTyID, contained->get_module()), contained_(contained) {
+  cache_spelling();
+}
 /**
  * @brief 创建一个指针类型
  *
@@ -357,3 +399,10 @@ PointerType *PointerType::get(Type *contained) {
  * @param m 所属模块
  */
 FloatType::FloatType(Module *m) : Type(Type::FloatTyID, m) {}
+/**
+ * @brief 创建一个浮点类型
+ *
+ * @param m 所属模块
+ * @return FloatType* 模块内唯一的浮点类型
+ */
+FloatType *FloatType::get(Module *m) { return m->get_float_type(); }
@@ -0,0 +1,128 @@
+/*!
+ *@file TypeContext.cpp
+ *@brief 类型上下文接口定义文件
+ *@version 1.0.0
+ *@date 2022-10-04
+ */
+#include "TypeContext.h"
+#include "Module.h"
+#include "Type.h"
+
+#include <cassert>
+#include <functional>
+
+namespace {
+/**
+ * @brief 合并散列值
+ *
+ * @param seed 已有散列值
+ * @param v 待合并的散列值
+ * @return std::size_t 合并结果
+ */
+std::size_t hash_combine(std::size_t seed, std::size_t v) {
+  return seed ^ (v + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+} // namespace
+
+/**
+ * @brief 数组类型结构的散列
+ *
+ * @param key 元素类型与元素个数
+ * @return std::size_t 散列值
+ */
+std::size_t TypeContext::ArrayKeyHash::operator()(const ArrayKey &key) const {
+  return hash_combine(std::hash<Type *>()(key.first), key.second);
+}
+
+/**
+ * @brief 函数类型结构的散列
+ *
+ * @param key 返回类型与参数类型列表
+ * @return std::size_t 散列值
+ */
+std::size_t
+TypeContext::FunctionKeyHash::operator()(const FunctionKey &key) const {
+  std::size_t seed = std::hash<Type *>()(key.result_);
+  for (auto param : *key.params_) {
+    seed = hash_combine(seed, std::hash<Type *>()(param));
+  }
+  return seed;
+}
+
+/**
+ * @brief Construct a new Type Context object，创建各基础类型
+ *
+ * @param m 所属模块
+ * @note 基础类型各只有一个，直接保存指针
+ */
+TypeContext::TypeContext(Module *m) : m_(m) {
+  void_ty_ = new (m) Type(Type::VoidTyID, m);
+  label_ty_ = new (m) Type(Type::LabelTyID, m);
+  int1_ty_ = new (m) IntegerType(1, m);
+  int32_ty_ = new (m) IntegerType(32, m);
+  float32_ty_ = new (m) FloatType(m);
+}
+
+/**
+ * @brief Get the int type object，按位数获取整数类型
+ *
+ * @param num_bits 位数：32/1
+ * @return IntegerType* 整数类型指针
+ */
+IntegerType *TypeContext::get_int_type(unsigned num_bits) const {
+  assert((num_bits == 1 || num_bits == 32) && "unsupported integer width");
+  return num_bits == 1 ? int1_ty_ : int32_ty_;
+}
+
+/**
+ * @brief Get the pointer type object，获取指向contained的指针类型
+ *
+ * @param contained 指针指向数据的类型
+ * @return PointerType* 指针类型指针
+ * @note 每个类型至多有一个指针类型，直接缓存在被指向的类型上，无需查表
+ * @note 多个线程同时首次获取时各自创建，只有比较交换成功的一个被发布，
+ * 其余的留在内存池中不再使用
+ */
+PointerType *TypeContext::get_pointer_type(Type *contained) {
+  PointerType *ptr = contained->pointer_to_.load(std::memory_order_acquire);
+  if (ptr != nullptr) {
+    return ptr;
+  }
+  auto fresh = new (m_) PointerType(contained);
+  if (contained->pointer_to_.compare_exchange_strong(
+          ptr, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return fresh;
+  }
+  return ptr;
+}
+
+/**
+ * @brief Get the array type object，获取唯一的数组类型
+ *
+ * @param contained 数组元素类型
+ * @param num_elements 数组元素个数
+ * @return ArrayType* 数组类型指针
+ */
+ArrayType *TypeContext::get_array_type(Type *contained,
+                                       unsigned num_elements) {
+  ArrayKey key{contained, num_elements};
+  return array_types_.get_or_create(key, [&] {
+    return std::make_pair(key, new (m_) ArrayType(contained, num_elements));
+  });
+}
+
+/**
+ * @brief Get the function type object，获取唯一的函数类型
+ *
+ * @param result 返回类型
+ * @param params 参数类型列表
+ * @return FunctionType* 函数类型指针
+ * @note 查找键指向传入的参数列表；新建时键改为指向函数类型自身保存的列表
+ */
+FunctionType *TypeContext::get_function_type(Type *result,
+                                             std::vector<Type *> params) {
+  return function_types_.get_or_create({result, &params}, [&] {
+    auto ty = new (m_) FunctionType(result, std::move(params));
+    return std::make_pair(FunctionKey{result, &ty->get_params()}, ty);
+  });
+}
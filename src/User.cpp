@@ -6,34 +6,91 @@
  */
 
 #include "User.h"
+#include "Module.h"
+#include "Type.h"
 #include <cassert>
+#include <new>
 
 /*!
  *@brief User的构造函数
  *@param ty 类型
+ *@param vid 子类型ID
  *@param name User名称
  *@param num_ops value的位置
+ *@param hung_off operand槽是否为独立分配
  *@return 当前对象本身
  *@note
  *---------
- *初始化operands数组全为nullptr
+ *初始化operands槽，每个槽为一个未挂链的use节点，value全为nullptr
  */
-User::User(Type *ty, const std::string &name, unsigned num_ops)
-    : Value(ty, name), num_ops_(num_ops) {
-  operands_.resize(num_ops_, nullptr);
+User::User(Type *ty, unsigned vid, std::string_view name, unsigned num_ops,
+           bool hung_off)
+    : Value(ty, vid, name), num_ops_(num_ops), hung_off_ops_(hung_off),
+      reserved_ops_(0) {
+  if (hung_off) {
+    *hung_off_slot() = nullptr;
+    num_ops_ = 0;
+    grow_operands(num_ops);
+    num_ops_ = num_ops;
+  }
+  Use *ops = op_begin();
+  for (unsigned i = 0; i < num_ops; i++) {
+    new (&ops[i]) Use(this, i);
+  }
 }
 
 /*!
- *@brief 获得包含value指针的数组
- *@return 返回User维护的Value数组
+ *@brief User的析构函数
+ *@note
+ *---------
+ *摘除所有operand的use节点，operand槽的内存归模块内存池所有
  */
-std::vector<Value *> &User::get_operands() { return operands_; }
+User::~User() {
+  Use *ops = op_begin();
+  for (unsigned i = 0; i < num_ops_; i++) {
+    ops[i].unlink();
+    ops[i].~Use();
+  }
+}
+
+/*!
+ *@brief 扩充独立分配operand槽的容量
+ *@param n 新容量
+ *@note
+ *---------
+ *已挂链的use节点原位迁移：新节点接管旧节点在use链中的位置，
+ *新槽从模块内存池分配，旧槽随内存池一并释放
+ */
+void User::grow_operands(unsigned n) {
+  assert(hung_off_ops_ && "fixed operands can not grow");
+  if (n <= reserved_ops_) {
+    return;
+  }
+  Use *old_ops = *hung_off_slot();
+  Use *ops = static_cast<Use *>(get_type()->get_module()->allocate(
+      sizeof(Use) * n, alignof(Use), Arena::OperandKind));
+  for (unsigned i = 0; i < num_ops_; i++) {
+    Use *old_use = &old_ops[i];
+    Use *new_use = new (&ops[i]) Use(this, i);
+    new_use->used_ = old_use->used_;
+    if (old_use->is_linked()) {
+      new_use->next_ = old_use->next_;
+      new_use->prev_ = old_use->prev_;
+      *new_use->prev_ = new_use;
+      if (new_use->next_)
+        new_use->next_->prev_ = &new_use->next_;
+    }
+    old_use->~Use();
+  }
+  *hung_off_slot() = ops;
+  reserved_ops_ = n;
+}
 
 /*!
  *@brief 获得数组中的第i个value数值指针
  *@return 获得数组中的第i个value数值常量指针
  */
-Value *User::get_operand(unsigned i) const { return operands_[i]; }
+Value *User::get_operand(unsigned i) const { return op_begin()[i].get(); }
 
 /*!
  *@brief 设置数组中的第i个value数值指针
@@ -42,15 +99,12 @@ Value *User::get_operand(unsigned i) const { return operands_[i]; }
  *设置数组中的第i个value数值常量指针
  *设置界限检查，查看索引i是否超限
  *--------
- *&emsp; value数组尾插入一个value
- *&emsp; 为value添加一个use关系
- *&emsp; 计数加一
+ *&emsp; 旧value的use链中摘除该槽
+ *&emsp; 新value的use链中挂入该槽
  */
 void User::set_operand(unsigned i, Value *v) {
   assert(i < num_ops_ && "set_operand out of index");
-  // assert(operands_[i] == nullptr && "ith operand is not null");
-  operands_[i] = v;
-  v->add_use(this, i);
+  op_begin()[i].set(v);
 }
 
 /*!
@@ -58,36 +112,31 @@ void User::set_operand(unsigned i, Value *v) {
  *@param v value数值指针
  *@note
  *--------
+ *&emsp; 容量不足时按倍数扩充operand槽
  *&emsp; value数组尾插入一个value
  *&emsp; 为value添加一个use关系
  *&emsp; 计数加一
  */
 void User::add_operand(Value *v) {
-  operands_.push_back(v);
-  v->add_use(this, num_ops_);
+  assert(hung_off_ops_ && "add_operand on fixed operands");
+  if (num_ops_ == reserved_ops_) {
+    grow_operands(reserved_ops_ ? reserved_ops_ * 2 : 2);
+  }
+  Use *use = new (&op_begin()[num_ops_]) Use(this, num_ops_);
+  use->set(v);
   num_ops_++;
 }
 
 /*!
- *@brief 获取User维护的operand数量
- *@return operand常量数值
- *@note
- *-------
- *判断
- */
-unsigned User::get_num_operand() const { return num_ops_; }
-
-/*!
- *@brief 添加新的value数值指针
- *@param v value数值指针
+ *@brief 将所有operand的use节点从各自的use链上摘除
  *@note
  *--------
- *遍历operands链表，对于每个value量的use_list进行检查
- *在operands表中删除对于本对象的使用
+ *遍历operands槽，逐个摘除，operand数值保持不变
  */
 void User::remove_use_of_ops() {
-  for (auto op : operands_) {
-    op->remove_use(this);
+  Use *ops = op_begin();
+  for (unsigned i = 0; i < num_ops_; i++) {
+    ops[i].unlink();
   }
 }
 
@@ -97,14 +146,20 @@ void User::remove_use_of_ops() {
  *@param index2 索引2
  *@note
  *--------
- *遍历operands表索引范围，删除对于本user的使用
- *删除本表的相关operands
+ *摘除索引范围内的use节点
+ *将其后的operands前移，重新挂链以保持arg_no连续
  *修改operands_size
  */
 void User::remove_operands(int index1, int index2) {
-  for (int i = index1; i <= index2; i++) {
-    operands_[i]->remove_use(this);
+  assert(hung_off_ops_ && "remove_operands on fixed operands");
+  Use *ops = op_begin();
+  unsigned removed = index2 - index1 + 1;
+  for (unsigned i = index1; i < num_ops_; i++) {
+    Value *v = i + removed < num_ops_ ? ops[i + removed].get() : nullptr;
+    ops[i].set(v);
+  }
+  for (unsigned i = num_ops_ - removed; i < num_ops_; i++) {
+    ops[i].~Use();
   }
-  operands_.erase(operands_.begin() + index1, operands_.begin() + index2 + 1);
-  num_ops_ = operands_.size();
+  num_ops_ -= removed;
 }
@@ -8,74 +8,145 @@
 #include <cassert>
 
 #include "BasicBlock.h"
+#include "Instruction.h"
+#include "Module.h"
 #include "Type.h"
 #include "User.h"
 #include "Value.h"
 /*!
  *@brief Value的构造函数
  *@param ty 类型
+ *@param vid 子类型ID
  *@param name value名称
  *@return 当前对象本身
  */
-Value::Value(Type *ty, const std::string &name) : type_(ty), name_(name) {}
+Value::Value(Type *ty, unsigned vid, std::string_view name)
+    : value_id_(vid), type_(ty) {
+  type_->get_module()->own(this);
+  set_name(name);
+}
+
+/*!
+ *@brief value的打印
+ *@return 字符串
+ *@note 字符串输出流不经缓冲，直接追加到结果中
+ */
+std::string Value::print() {
+  std::string str;
+  StringOutStream os(str);
+  print_ir(os);
+  return str;
+}
+
+/*!
+ *@brief Value的析构函数
+ *@note 从所属模块中撤销登记，内存归模块内存池或函数的空闲链表管理
+ */
+Value::~Value() { type_->get_module()->disown(this); }
 
 /*!
- *@brief 添加use
- *@param val 使用该value的value
- *@param arg_no 在指令中的顺序
+ *@brief 从模块内存池中分配value
+ *@param size 对象大小
+ *@param m 所属模块
+ *@param kind 对象种类，用于统计
+ *@param prefix 对象之前预留的字节数，存放operand槽
+ *@return 对象起始地址
+ */
+void *Value::allocate(std::size_t size, Module *m, Arena::Kind kind,
+                      std::size_t prefix) {
+  char *mem = static_cast<char *>(
+      m->allocate(prefix + size, alignof(Use), kind));
+  return mem + prefix;
+}
+
+/*!
+ *@brief 修改被使用的value
+ *@param v 新的被使用value，可以为空
  *@note
  *---------
- *在use链中添加
+ *先从旧value的use链上摘除，再挂入新value的use链，均为O(1)
  */
-void Value::add_use(Value *val, unsigned arg_no) {
-  use_list_.push_back(Use(val, arg_no));
+void Use::set(Value *v) {
+  unlink();
+  used_ = v;
+  if (v) {
+    v->add_use(this);
+    if (uses_block())
+      update_cfg_edge(true);
+  }
 }
+
 /*!
- *@brief 获取value的名称
- *@return value字符串常量
+ *@brief 同步跳转指令目标的前置基本块
+ *@param linked 挂链为true，摘链为false
+ *@note
+ *---------
+ *后继基本块由终结指令的operand直接得到，前置基本块随跳转指令的
+ *use节点挂链、摘链增删；未插入基本块的跳转指令不产生边
  */
-std::string Value::get_name() const { return name_; }
+void Use::update_cfg_edge(bool linked) {
+  auto br = dyn_cast<BranchInst>(val_);
+  if (br == nullptr || br->get_parent() == nullptr)
+    return;
+  auto target = cast<BasicBlock>(used_);
+  if (linked)
+    target->add_pre_basic_block(br->get_parent());
+  else
+    target->remove_pre_basic_block(br->get_parent());
+}
+/*!
+ *@brief 对于value设置名称
+ *@param name value名称
+ *@return 名称设置的布尔结果
+ *@note
+ *---------
+ *名字为空即设置新名字，设置后不再进行修改
+ *名称收录到模块的字符串池，空名称不占用存储
+ */
+bool Value::set_name(std::string_view name) {
+  if (name_ != nullptr) {
+    return false;
+  }
+  if (!name.empty()) {
+    name_ = type_->get_module()->intern_name(name);
+  }
+  return true;
+}
 /*!
  *@brief 替换所有对于旧value的引用，改为新的
  *@param new_val value型指针
  *@note
  *--------
  *支持对于所有的value的修改，包括基本块
- *&emsp; 首先遍历所属的use_list，修改其他value中对于当前value的引用为新value
- *&emsp; 转换value类型为basicblock，修改成功即为对基本块间的类型调用修改，
- *&emsp; 依次修改前置后置的链表中对于该基本块的引用
+ *&emsp; 首先遍历所属的use_list，修改其他value中对于当前value的引用为新value，
+ *&emsp; 每个use节点直接转挂到新value的use链上
+ *&emsp; 替换基本块时，跳转指令的use节点转挂即同步了前置基本块
  */
 void Value::replace_all_use_with(Value *new_val) {
-  for (auto use : use_list_) {
-    auto val = dynamic_cast<User *>(use.val_);
-    assert(val && "new_val is not a user");
-    val->set_operand(use.arg_no_, new_val);
+  if (new_val == this) {
+    return;
   }
-  auto val = dynamic_cast<BasicBlock *>(this);
-  if (val) {
-    auto new_bb = dynamic_cast<BasicBlock *>(new_val);
-    for (BasicBlock *pre_bb : val->get_pre_basic_blocks()) {
-      pre_bb->remove_succ_basic_block(val);
-      pre_bb->add_succ_basic_block(new_bb);
-      new_bb->add_pre_basic_block(pre_bb);
-    }
-    for (BasicBlock *suc_bb : val->get_succ_basic_blocks()) {
-      suc_bb->remove_pre_basic_block(val);
-      suc_bb->add_pre_basic_block(new_bb);
-      new_bb->add_succ_basic_block(suc_bb);
-    }
+  while (!use_list_.empty()) {
+    use_list_.front().set(new_val);
   }
 }
 
 /*!
- *@brief 替换所有对于旧value的引用，改为新的
+ *@brief 删除val对于本value的所有使用
  *@param val value型指针
  *@note
  *----------
- *设置lambda函数，判定val的匹配
- *匹配成功则进行value的相关删除
+ *遍历val的operand槽，将指向本value的use节点从use链上摘除
  */
 void Value::remove_use(Value *val) {
-  auto is_val = [val](const Use &use) { return use.val_ == val; };
-  use_list_.remove_if(is_val);
+  auto user = dyn_cast<User>(val);
+  if (user == nullptr) {
+    return;
+  }
+  for (unsigned i = 0; i < user->get_num_operand(); i++) {
+    Use &use = user->get_operand_use(i);
+    if (use.get() == this) {
+      use.unlink();
+    }
+  }
 }
\ No newline at end of file